@@ -0,0 +1,86 @@
+/* File:     antialias.h
+ *
+ * Purpose:  edge-adaptive supersampling. After the normal one sample per pixel
+ *           render, a pixel is flagged when one of its 8 neighbours got the other
+ *           value, only those pixels are on an edge of the set. Every flagged pixel
+ *           is sampled again on an AA_SAMPLES x AA_SAMPLES grid with each sample
+ *           jittered inside its grid cell, and the coverage is blended with the
+ *           centre sample.
+ *
+ *           The jitter comes from a hash of the pixel and sample index instead of
+ *           rand() so it needs no shared state and the image does not depend on
+ *           which thread got which pixel.
+ *
+ */
+
+#ifndef __ANTIALIAS_H__
+#define __ANTIALIAS_H__
+
+#include <vector>
+#include <stdint.h>
+#include <omp.h>
+#include "fractal.h"
+#include "distance.h"
+
+#define AA_SAMPLES 3    //jittered samples per side of a flagged pixel
+
+//true when a neighbour of pixel (x, y) in the 0/1 image vals has the other value
+inline bool aa_is_edge( const int *vals, int x, int y ) {
+    int v = vals[x + y * DIM];
+    for (int j=-1; j<=1; j++) {
+        for (int i=-1; i<=1; i++) {
+            int nx = x + i, ny = y + j;
+            if (nx >= 0 && nx < DIM && ny >= 0 && ny < DIM && vals[nx + ny * DIM] != v)
+                return true;
+        }
+    }
+    return false;
+}
+
+//offsets of all edge pixels, in no particular order
+inline void aa_flag_edges( const int *vals, std::vector<int> &flagged ) {
+    flagged.clear();
+    #pragma omp parallel
+    {
+        std::vector<int> my_flagged; //edge pixels of this thread's rows, appended to flagged once at the end
+
+        #pragma omp for schedule(static)
+        for (int y=0; y<DIM; y++) {
+            for (int x=0; x<DIM; x++) {
+                if (aa_is_edge(vals, x, y))
+                    my_flagged.push_back(x + y * DIM);
+            }
+        }
+
+        #pragma omp critical
+        flagged.insert(flagged.end(), my_flagged.begin(), my_flagged.end());
+    }
+}
+
+//hash of (offset, k) to a number in [0, 1)
+inline float aa_jitter( int offset, int k ) {
+    uint32_t h = (uint32_t)offset * 0x9E3779B1u ^ (uint32_t)k * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    h *= 0x297A2D39u;
+    h ^= h >> 15;
+    return (h >> 8) * (1.0f / (1 << 24));
+}
+
+//blended value of pixel (x, y): centre sample plus the jittered grid samples
+inline float aa_resample( int x, int y, int centre ) {
+    int offset = x + y * DIM;
+    int inside = centre;
+    for (int j=0; j<AA_SAMPLES; j++) {
+        for (int i=0; i<AA_SAMPLES; i++) {
+            int k = 2 * (i + j * AA_SAMPLES);
+            float sx = x + ((i + aa_jitter(offset, k)) / AA_SAMPLES - 0.5f);
+            float sy = y + ((j + aa_jitter(offset, k + 1)) / AA_SAMPLES - 0.5f);
+            inside += julia_sample(pixel_coord(sx), pixel_coord(sy));
+        }
+    }
+    return (float)inside / (AA_SAMPLES * AA_SAMPLES + 1);
+}
+
+#endif  // __ANTIALIAS_H__
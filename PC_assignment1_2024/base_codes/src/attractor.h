@@ -0,0 +1,147 @@
+/* File:     attractor.h
+ *
+ * Purpose:  every pixel of a julia set shares the same c, so the attracting cycle
+ *           of f(z) = z^2 + c (if there is one) can be found once per frame and then
+ *           used to stop interior pixels as soon as their orbit falls into it.
+ *
+ *           An attracting cycle always pulls in the critical point 0, so we follow
+ *           the critical orbit for a while, refine the point it settles on with
+ *           Newton's method on f^p(z) - z for p = 1, 2, ... and accept the first
+ *           period whose multiplier (f^p)'(z) = prod 2 z_k is inside the unit circle.
+ *           If the critical orbit escapes there is no attracting cycle and the
+ *           kernel just runs the normal escape loop.
+ *
+ */
+
+#ifndef __ATTRACTOR_H__
+#define __ATTRACTOR_H__
+
+#include <complex>
+#include <cmath>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "julia_precision.h"
+
+#define CYCLE_MAX_PERIOD 64     //longest cycle we look for
+#define CYCLE_WARMUP 10000      //critical orbit steps before looking for the cycle
+#define CYCLE_NEWTON_STEPS 50
+#define CYCLE_TOL 1e-12         //Newton has converged when a step is smaller than this
+#define CYCLE_RADIUS_SAMPLES 32 //points on the circle used to check the attraction radius
+
+struct AttractingCycle {
+    bool    found;
+    int     period;
+    double  zr, zi;         //one point of the cycle
+    double  multiplier;     //|(f^p)'| on the cycle, < 1 when attracting
+    double  radius;         //orbits that come closer than this to (zr, zi) are captured
+};
+
+typedef std::complex<double> cplx;
+
+//applies f p times to z, returns f^p(z) and its derivative in dfp
+inline cplx iterate_cycle( cplx z, cplx c, int p, cplx &dfp ) {
+    dfp = 1.0;
+    for (int k=0; k<p; k++) {
+        dfp *= 2.0 * z;
+        z = z * z + c;
+    }
+    return z;
+}
+
+//true when every sampled point on the circle of radius r around z0 is pulled
+//strictly closer to z0 by f^p, so orbits entering that disc stay in it
+inline bool radius_attracts( cplx z0, cplx c, int p, double r ) {
+    for (int k=0; k<CYCLE_RADIUS_SAMPLES; k++) {
+        double t = 2.0 * M_PI * k / CYCLE_RADIUS_SAMPLES;
+        cplx z = z0 + std::polar(r, t);
+        cplx dfp;
+        if (std::abs(iterate_cycle(z, c, p, dfp) - z0) >= 0.9 * r)
+            return false;
+    }
+    return true;
+}
+
+//per frame precomputation: finds the attracting cycle of z^2 + c, its period and a radius around
+//one of its points inside which orbits are known to be captured
+inline AttractingCycle find_attracting_cycle( double cr, double ci ) {
+    AttractingCycle cyc;
+    cyc.found = false;
+    cyc.period = 0;
+    cyc.zr = cyc.zi = 0.0;
+    cyc.multiplier = 0.0;
+    cyc.radius = 0.0;
+
+    cplx c(cr, ci);
+    cplx z = 0.0;
+    for (int i=0; i<CYCLE_WARMUP; i++) {
+        z = z * z + c;
+        if (std::norm(z) > BAILOUT)
+            return cyc; //critical point escapes, no attracting cycle
+    }
+
+    for (int p=1; p<=CYCLE_MAX_PERIOD; p++) {
+        //Newton on g(w) = f^p(w) - w, starting from the settled critical orbit
+        cplx w = z, dfp;
+        bool converged = false;
+        for (int k=0; k<CYCLE_NEWTON_STEPS; k++) {
+            cplx g = iterate_cycle(w, c, p, dfp) - w;
+            cplx step = g / (dfp - 1.0);
+            w -= step;
+            if (std::abs(step) < CYCLE_TOL) {
+                converged = true;
+                break;
+            }
+        }
+        if (!converged)
+            continue;
+
+        iterate_cycle(w, c, p, dfp);
+        double m = std::abs(dfp);
+        //a true attracting cycle of the critical orbit is close to where it settled
+        if (m >= 1.0 || std::abs(w - z) > 1e-3)
+            continue;
+
+        cyc.found = true;
+        cyc.period = p;
+        cyc.zr = w.real();
+        cyc.zi = w.imag();
+        cyc.multiplier = m;
+
+        //largest radius (halving from 0.5) for which the disc is still pulled in
+        double r = 0.5;
+        while (r > 1e-9 && !radius_attracts(w, c, p, r))
+            r *= 0.5;
+        cyc.radius = r > 1e-9 ? r : 0.0;
+        cyc.found = cyc.radius > 0.0;
+        return cyc;
+    }
+    return cyc;
+}
+
+//escape_orbit() watch that stops an orbit once it is inside the attraction disc
+struct CycleWatch {
+    bool    found;
+    float   zr, zi, r2;
+
+    CycleWatch( const AttractingCycle &cyc )
+        : found(cyc.found), zr((float)cyc.zr), zi((float)cyc.zi), r2((float)(cyc.radius * cyc.radius)) {}
+
+    void before_step( const cuComplex & ) {}
+
+    bool captured( const cuComplex &a ) {
+        if (!found)
+            return false;
+        float dr = a.r - zr, di = a.i - zi;
+        return dr * dr + di * di < r2;
+    }
+};
+
+//julia() with the interior exit: once the orbit is inside the attraction disc it can never escape
+//the cycle test is skipped when no attracting cycle was found, which gives exactly the julia() loop
+inline int julia_attractor( int x, int y, int max_iter, const AttractingCycle &cyc, int *iterations ) {
+    cuComplex a(pixel_coord(x), pixel_coord(y));
+    CycleWatch watch(cyc);
+    return escape_orbit(a, max_iter, watch, *iterations) ? 0 : 1;
+}
+
+#endif  // __ATTRACTOR_H__
@@ -0,0 +1,143 @@
+/* File:     autotune.h
+ *
+ * Purpose:  autotuner for the 2D block-cyclic kernel. After one warm-up render it
+ *           times the kernel over a sweep of tile shapes at the default thread count,
+ *           then over thread counts with the best shape, keeping the fastest of
+ *           TUNE_REPEATS renders per configuration, and writes the winner to TUNE_FILE in the
+ *           working directory. Later runs load that file on startup, so every
+ *           machine keeps its own best configuration.
+ *
+ *           The file is plain "key value" lines and remembers the host it was tuned
+ *           on, a file copied or shared from another machine is ignored.
+ *
+ */
+
+#ifndef __AUTOTUNE_H__
+#define __AUTOTUNE_H__
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <omp.h>
+#include "fractal.h"
+
+#define TUNE_FILE "fractal_tune.cfg"
+#define TUNE_REPEATS 3      //renders per configuration, the fastest one is kept
+
+struct TuneConfig {
+    int     tile_w, tile_h;
+    int     threads;
+    double  seconds;    //fastest of TUNE_REPEATS renders with this configuration, 0 when not measured
+
+    TuneConfig( void ) : tile_w(32), tile_h(32), threads(NUM_THREADS), seconds(0.0) {}
+};
+
+inline std::string tune_host( void ) {
+    char name[256];
+    if (gethostname(name, sizeof(name)) != 0)
+        return "unknown";
+    name[sizeof(name) - 1] = '\0';
+    return name;
+}
+
+//true when path holds a configuration tuned on this host, cfg is only changed then
+inline bool load_tune_config( const char *path, TuneConfig &cfg ) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return false;
+
+    TuneConfig read;
+    char key[64], value[256];
+    bool same_host = false;
+    while (fscanf(f, "%63s %255s", key, value) == 2) {
+        if (strcmp(key, "host") == 0)
+            same_host = tune_host() == value;
+        else if (strcmp(key, "tile_w") == 0)
+            read.tile_w = atoi(value);
+        else if (strcmp(key, "tile_h") == 0)
+            read.tile_h = atoi(value);
+        else if (strcmp(key, "threads") == 0)
+            read.threads = atoi(value);
+        else if (strcmp(key, "seconds") == 0)
+            read.seconds = atof(value);
+    }
+    fclose(f);
+
+    if (!same_host || read.tile_w <= 0 || read.tile_h <= 0 || read.threads <= 0)
+        return false;
+    //the file is hand editable, keep tiles inside the image and threads to what a sweep could pick
+    read.tile_w = std::min(read.tile_w, DIM);
+    read.tile_h = std::min(read.tile_h, DIM);
+    read.threads = std::min(read.threads, std::max(2*omp_get_num_procs(), NUM_THREADS));
+    cfg = read;
+    return true;
+}
+
+inline bool save_tune_config( const char *path, const TuneConfig &cfg ) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+        return false;
+    fprintf(f, "host %s\ntile_w %d\ntile_h %d\nthreads %d\nseconds %g\n",
+            tune_host().c_str(), cfg.tile_w, cfg.tile_h, cfg.threads, cfg.seconds);
+    fclose(f);
+    return true;
+}
+
+//fastest of TUNE_REPEATS runs of kernel(tile_w, tile_h, threads)
+template <typename Kernel>
+double tune_time( Kernel &kernel, int tile_w, int tile_h, int threads ) {
+    double best = HUGE_VAL;
+    for (int r=0; r<TUNE_REPEATS; r++) {
+        double start = omp_get_wtime();
+        kernel(tile_w, tile_h, threads);
+        best = std::min(best, omp_get_wtime() - start);
+    }
+    return best;
+}
+
+//times kernel(tile_w, tile_h, threads) over the sweep and returns the fastest configuration
+template <typename Kernel>
+TuneConfig autotune_blockcyclic( Kernel kernel ) {
+    static const int widths[] = { 16, 32, 64, 128, DIM };
+    static const int heights[] = { 1, 4, 16, 64 };
+    TuneConfig best;
+    best.seconds = HUGE_VAL;
+
+    //warm up so the first shape does not pay for thread creation and cold caches
+    kernel(best.tile_w, best.tile_h, NUM_THREADS);
+
+    for (size_t i=0; i<sizeof(widths)/sizeof(widths[0]); i++) {
+        for (size_t j=0; j<sizeof(heights)/sizeof(heights[0]); j++) {
+            double t = tune_time(kernel, widths[i], heights[j], NUM_THREADS);
+            if (t < best.seconds) {
+                best.tile_w = widths[i];
+                best.tile_h = heights[j];
+                best.seconds = t;
+            }
+        }
+    }
+
+    //powers of two up to twice the cores, plus the compiled in default
+    std::vector<int> counts;
+    for (int threads=1; threads<=2*omp_get_num_procs(); threads*=2)
+        counts.push_back(threads);
+    if (std::find(counts.begin(), counts.end(), NUM_THREADS) == counts.end())
+        counts.push_back(NUM_THREADS);
+    for (size_t k=0; k<counts.size(); k++) {
+        if (counts[k] == NUM_THREADS)
+            continue; //already timed in the shape sweep
+        double t = tune_time(kernel, best.tile_w, best.tile_h, counts[k]);
+        if (t < best.seconds) {
+            best.threads = counts[k];
+            best.seconds = t;
+        }
+    }
+    return best;
+}
+
+#endif  // __AUTOTUNE_H__
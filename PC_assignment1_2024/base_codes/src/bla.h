@@ -0,0 +1,88 @@
+/* File:     bla.h
+ *
+ * Purpose:  bilinear approximation (BLA) tables that let a perturbation pixel
+ *           skip many iterations of the reference orbit in one step.
+ *
+ *           For a julia set c is the same for every pixel so the delta iteration
+ *           d_{n+1} = 2 Z_n d_n + d_n^2 has no dc term, and while |d_n| is tiny
+ *           next to |Z_n| it is just the linear map d -> A d with A = 2 Z_n.
+ *           Two neighbouring steps merge into one (A = A_y A_x) and the merged
+ *           steps merge again, so level k of the table jumps 2^k iterations.
+ *
+ *           The table is built once per frame and only read by the render threads.
+ *
+ */
+
+#ifndef __BLA_H__
+#define __BLA_H__
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+//relative size of the dropped d^2 term we accept per step
+#define BLA_EPSILON (1.0 / (1 << 24))
+
+//jumps from d_n to d_{n+2^k} ~= A d_n, valid while |d_n| < r
+struct BlaEntry {
+    double ar, ai;
+    double r;
+};
+
+struct BlaTable {
+    std::vector< std::vector<BlaEntry> > levels;    //levels[k][j] starts at iteration j * 2^k
+};
+
+//builds all levels from the reference orbit Z_0 .. Z_length
+inline void build_bla_table( BlaTable &bla, const std::vector<double> &zr,
+                             const std::vector<double> &zi, int length ) {
+    bla.levels.clear();
+    if (length <= 0)
+        return;
+
+    //level 0: single steps, A = 2 Z_n and the d^2 term stays below epsilon while |d| < epsilon |A|
+    bla.levels.push_back(std::vector<BlaEntry>(length));
+    std::vector<BlaEntry> &base = bla.levels[0];
+    #pragma omp parallel for schedule(static)
+    for (int n=0; n<length; n++) {
+        base[n].ar = 2.0 * zr[n];
+        base[n].ai = 2.0 * zi[n];
+        base[n].r = BLA_EPSILON * hypot(base[n].ar, base[n].ai);
+    }
+
+    //every level merges pairs of the one below, x first then y
+    while (bla.levels.back().size() >= 2) {
+        const std::vector<BlaEntry> &lower = bla.levels.back();
+        std::vector<BlaEntry> upper(lower.size() / 2);
+        #pragma omp parallel for schedule(static)
+        for (int j=0; j<(int)upper.size(); j++) {
+            const BlaEntry &x = lower[2*j];
+            const BlaEntry &y = lower[2*j + 1];
+            upper[j].ar = y.ar * x.ar - y.ai * x.ai;
+            upper[j].ai = y.ar * x.ai + y.ai * x.ar;
+            //d must be valid for x, and A_x d must be valid for y
+            upper[j].r = std::min(x.r, y.r / hypot(x.ar, x.ai));
+        }
+        bla.levels.push_back(upper);
+    }
+}
+
+//largest jump that can be taken from iteration n with delta (dr, di) without passing
+//iteration limit, returns the level (>= 1) or 0 when a normal step has to be done
+inline int bla_lookup( const BlaTable &bla, int n, double dr, double di, int limit ) {
+    double d2 = dr * dr + di * di;
+    for (int k = (int)bla.levels.size() - 1; k >= 1; k--) {
+        int step = 1 << k;
+        if (n % step != 0 || n + step > limit)
+            continue;
+        int j = n >> k;
+        if (j >= (int)bla.levels[k].size())
+            continue;
+        double r = bla.levels[k][j].r;
+        if (d2 < r * r)
+            return k;
+    }
+    return 0;
+}
+
+#endif  // __BLA_H__
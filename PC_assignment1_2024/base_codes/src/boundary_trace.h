@@ -0,0 +1,176 @@
+/* File:     boundary_trace.h
+ *
+ * Purpose:  boundary tracing renderer. Only pixels on the contours between
+ *           different values are computed, the regions they enclose are filled.
+ *
+ *           Tracing starts from a queue holding the edge pixels of the tile and a
+ *           grid of seed lines every BT_SEED pixels. Every pixel taken out of the
+ *           queue is computed. If it differs from an already computed neighbour,
+ *           a contour runs between them and the uncomputed neighbours of both are
+ *           queued. When the queue is empty every contour that was reached has
+ *           been walked.
+ *
+ *           The pixels still unknown then sit in cells of the seed grid that no
+ *           contour entered, but a small island can hide in such a cell. So a cell
+ *           is only filled when classify_tile() from interval.h proves its value,
+ *           otherwise its unknown pixels are computed. That makes the result exact.
+ *           The proof is about julia() on the full view, which is what fn has to
+ *           compute.
+ *
+ *           The parallel version traces independent tiles, each with its own edge,
+ *           so tiles never need to talk to each other.
+ *
+ */
+
+#ifndef __BOUNDARY_TRACE_H__
+#define __BOUNDARY_TRACE_H__
+
+#include <algorithm>
+#include <vector>
+#include <omp.h>
+#include "fractal.h"
+#include "interval.h"
+
+#define BT_TILE 64              //tile width and height of the parallel version
+#define BT_SEED 8               //spacing of the seed lines, the cells between them are what gets proven
+
+//pixel states in the status array
+#define BT_UNKNOWN 0
+#define BT_QUEUED 1
+#define BT_DONE 2
+
+//traces the tile [x0, x1) x [y0, y1), writes vals and status for its pixels only,
+//returns the number of fn calls
+template <typename PixelFn>
+long long boundary_trace_tile( int *vals, unsigned char *status, int x0, int y0, int x1, int y1, PixelFn &fn ) {
+    std::vector<int> queue;
+    long long calls = 0;
+
+    for (int y=y0; y<y1; y++)
+        for (int x=x0; x<x1; x++)
+            status[x + y*DIM] = BT_UNKNOWN;
+
+    //the tile edge is where tracing starts
+    for (int x=x0; x<x1; x++) {
+        queue.push_back(x + y0*DIM);
+        queue.push_back(x + (y1-1)*DIM);
+    }
+    for (int y=y0+1; y<y1-1; y++) {
+        queue.push_back(x0 + y*DIM);
+        queue.push_back(x1-1 + y*DIM);
+    }
+    for (int y=y0+1; y<y1-1; y++) {
+        for (int x=x0+1; x<x1-1; x++) {
+            if (x % BT_SEED == 0 || y % BT_SEED == 0)
+                queue.push_back(x + y*DIM);
+        }
+    }
+    for (size_t k=0; k<queue.size(); k++)
+        status[queue[k]] = BT_QUEUED;
+
+    //enqueues the unknown 8-neighbours of pixel (x, y) inside the tile
+    auto push_neighbours = [&](int x, int y) {
+        for (int dy=-1; dy<=1; dy++) {
+            for (int dx=-1; dx<=1; dx++) {
+                int nx = x + dx, ny = y + dy;
+                if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1)
+                    continue;
+                if (status[nx + ny*DIM] == BT_UNKNOWN) {
+                    status[nx + ny*DIM] = BT_QUEUED;
+                    queue.push_back(nx + ny*DIM);
+                }
+            }
+        }
+    };
+
+    //the queue is used as a stack, the order does not change the result
+    while (!queue.empty()) {
+        int offset = queue.back();
+        queue.pop_back();
+        int x = offset % DIM, y = offset / DIM;
+        vals[offset] = fn(x, y);
+        status[offset] = BT_DONE;
+        calls++;
+
+        for (int dy=-1; dy<=1; dy++) {
+            for (int dx=-1; dx<=1; dx++) {
+                int nx = x + dx, ny = y + dy;
+                if ((dx == 0 && dy == 0) || nx < x0 || nx >= x1 || ny < y0 || ny >= y1)
+                    continue;
+                int n = nx + ny*DIM;
+                if (status[n] == BT_DONE && vals[n] != vals[offset]) {
+                    push_neighbours(x, y);
+                    push_neighbours(nx, ny);
+                }
+            }
+        }
+    }
+
+    //whatever was never reached lies in a cell of the seed grid that no contour entered,
+    //an island there would have been missed. The cell takes the value classify_tile()
+    //proves for it, or when there is no proof its unreached pixels are computed
+    for (int cy=y0; cy<y1; cy=(cy / BT_SEED + 1) * BT_SEED) {
+        for (int cx=x0; cx<x1; cx=(cx / BT_SEED + 1) * BT_SEED) {
+            int cx1 = std::min((cx / BT_SEED + 1) * BT_SEED, x1);
+            int cy1 = std::min((cy / BT_SEED + 1) * BT_SEED, y1);
+            bool reached = true;
+            for (int y=cy; y<cy1 && reached; y++) {
+                for (int x=cx; x<cx1; x++) {
+                    if (status[x + y*DIM] != BT_DONE) {
+                        reached = false;
+                        break;
+                    }
+                }
+            }
+            if (reached)
+                continue;
+
+            TileVerdict verdict = classify_tile(cx, cy, cx1, cy1);
+            for (int y=cy; y<cy1; y++) {
+                for (int x=cx; x<cx1; x++) {
+                    int offset = x + y*DIM;
+                    if (status[offset] == BT_DONE)
+                        continue;
+                    if (verdict == TILE_UNKNOWN) {
+                        vals[offset] = fn(x, y);
+                        calls++;
+                    } else {
+                        vals[offset] = verdict == TILE_BOUNDED;
+                    }
+                    status[offset] = BT_DONE;
+                }
+            }
+        }
+    }
+    return calls;
+}
+
+//whole image traced as one tile by the calling thread
+template <typename PixelFn>
+long long boundary_trace( int *vals, PixelFn fn ) {
+    unsigned char *status = new unsigned char[DIM*DIM];
+    long long calls = boundary_trace_tile(vals, status, 0, 0, DIM, DIM, fn);
+    delete [] status;
+    return calls;
+}
+
+//image split into BT_TILE tiles that are traced independently by the threads
+template <typename PixelFn>
+long long boundary_trace_tiled( int *vals, PixelFn fn ) {
+    unsigned char *status = new unsigned char[DIM*DIM];
+    const int tiles_x = (DIM + BT_TILE - 1) / BT_TILE;
+    const int tiles = tiles_x * tiles_x;
+    long long calls = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:calls)
+    for (int t=0; t<tiles; t++) {
+        int x0 = (t % tiles_x) * BT_TILE, y0 = (t / tiles_x) * BT_TILE;
+        int x1 = x0 + BT_TILE < DIM ? x0 + BT_TILE : DIM;
+        int y1 = y0 + BT_TILE < DIM ? y0 + BT_TILE : DIM;
+        calls += boundary_trace_tile(vals, status, x0, y0, x1, y1, fn);
+    }
+    delete [] status;
+    return calls;
+}
+
+#endif  // __BOUNDARY_TRACE_H__
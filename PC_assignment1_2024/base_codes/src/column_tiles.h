@@ -0,0 +1,71 @@
+/* File:     column_tiles.h
+ *
+ * Purpose:  column decomposition without the column stride on every store. Each
+ *           thread owns a block of whole CT_COLS wide column strips. It walks a
+ *           strip column by column like a real column kernel, but the results go
+ *           into a small thread local tile stored transposed (one column after the
+ *           other), and the tile is then written back row by row. Every write-back
+ *           row is CT_COLS pixels = one 64 byte cache line, instead of one pixel
+ *           per line with the plain column walk.
+ *
+ *           The tiles are aligned to the cache line so two threads' tiles never
+ *           share one, and column blocks are whole strips so threads also write
+ *           disjoint lines of the image (as far as the bitmap's own alignment allows,
+ *           it comes from new[] in cpu_bitmap.h).
+ *
+ */
+
+#ifndef __COLUMN_TILES_H__
+#define __COLUMN_TILES_H__
+
+#include <omp.h>
+#include "fractal.h"
+#include "render_driver.h"
+
+#define CACHE_LINE 64
+#define CT_COLS (CACHE_LINE / 4)    //columns per strip, one cache line of rgba pixels
+#define CT_ROWS 64                  //rows per tile, a tile of int values is 4KB
+
+//thread owns strips [first, last) of the image, renders them column-wise through the tile
+template <typename PixelFn, typename Writer>
+void column_tiles_block( PixelFn pixel, const Writer &writer, int first, int last ) {
+    alignas(CACHE_LINE) int tile[CT_COLS][CT_ROWS]; //tile[c][r] = value of pixel (x0 + c, y0 + r)
+
+    for (int strip=first; strip<last; strip++) {
+        int x0 = strip * CT_COLS;
+        int x1 = x0 + CT_COLS < DIM ? x0 + CT_COLS : DIM;
+        for (int y0=0; y0<DIM; y0+=CT_ROWS) {
+            int y1 = y0 + CT_ROWS < DIM ? y0 + CT_ROWS : DIM;
+
+            //column-major compute, contiguous in the tile
+            for (int x=x0; x<x1; x++) {
+                for (int y=y0; y<y1; y++)
+                    tile[x - x0][y - y0] = pixel(x, y);
+            }
+
+            //blocked transpose, one full line of the image per row
+            for (int y=y0; y<y1; y++) {
+                for (int x=x0; x<x1; x++)
+                    writer.write(x, y, tile[x - x0][y - y0]);
+            }
+        }
+    }
+}
+
+//column block decomposition of the whole image on threads threads, writer stores the
+//values like it does for render()
+template <typename PixelFn, typename Writer>
+void column_tiles( PixelFn pixel, const Writer &writer, int threads ) {
+    const int strips = (DIM + CT_COLS - 1) / CT_COLS;
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int tid = omp_get_thread_num(), nthreads = omp_get_num_threads();
+        int per = strips / nthreads, extra = strips % nthreads;
+        int first = tid * per + (tid < extra ? tid : extra);
+        int last = first + per + (tid < extra ? 1 : 0);
+        column_tiles_block( pixel, writer, first, last );
+    }
+}
+
+#endif  // __COLUMN_TILES_H__
@@ -0,0 +1,77 @@
+/* File:     cpu_dispatch.h
+ *
+ * Purpose:  picks which SIMD build of the julia kernel to run on this machine.
+ *           The binary is compiled for generic x86-64 and the wide kernels carry
+ *           their own target attributes, so we ask cpuid (and xgetbv for the
+ *           OS saved register state) what is safe before calling any of them.
+ *
+ */
+
+#ifndef __CPU_DISPATCH_H__
+#define __CPU_DISPATCH_H__
+
+#include <cpuid.h>
+#include <cstring>
+#include "julia_simd.h"
+
+//instruction set levels we have kernels for, ordered from slowest to fastest
+enum Isa { ISA_SCALAR = 0, ISA_SSE2, ISA_AVX2, ISA_AVX512, ISA_COUNT };
+
+static const char *isa_names[ISA_COUNT] = { "scalar", "sse2", "avx2", "avx512" };
+
+//pixels evaluated per call for each level (scalar goes through julia() one at a time)
+static const int isa_lanes[ISA_COUNT] = { 1, SSE2_LANES, AVX2_LANES, AVX512_LANES };
+
+//reads the xcr0 register which says which vector registers the OS saves on a context switch
+inline unsigned long long read_xcr0( void ) {
+    unsigned int eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+//true when both the cpu and the OS support the given level
+inline bool isa_supported( Isa isa ) {
+    unsigned int eax, ebx, ecx, edx;
+    if (isa == ISA_SCALAR)
+        return true;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (isa == ISA_SSE2)
+        return (edx & bit_SSE2) != 0;
+
+    //avx and up need osxsave and the ymm state enabled in xcr0
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return false;
+    unsigned long long xcr0 = read_xcr0();
+    if ((xcr0 & 0x6) != 0x6)
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (isa == ISA_AVX2)
+        return (ebx & bit_AVX2) != 0;
+
+    //avx-512 also needs the opmask and zmm state (bits 5-7)
+    return (ebx & bit_AVX512F) != 0 && (xcr0 & 0xE6) == 0xE6;
+}
+
+//highest level this machine can run
+inline Isa detect_isa( void ) {
+    for (int isa = ISA_COUNT - 1; isa > ISA_SCALAR; isa--) {
+        if (isa_supported((Isa)isa))
+            return (Isa)isa;
+    }
+    return ISA_SCALAR;
+}
+
+//maps a name given on the command line to a level, returns false for unknown names
+inline bool parse_isa( const char *name, Isa *isa ) {
+    for (int i = 0; i < ISA_COUNT; i++) {
+        if (strcmp(name, isa_names[i]) == 0) {
+            *isa = (Isa)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif  // __CPU_DISPATCH_H__
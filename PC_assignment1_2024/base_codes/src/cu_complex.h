@@ -0,0 +1,30 @@
+/* File:     cu_complex.h
+ *
+ * Purpose:  complex number type used by the julia functions, templated on the
+ *           scalar so the same escape loop can run in float, double, long double
+ *           or double-double (see double_double.h)
+ *
+ */
+
+#ifndef __CU_COMPLEX_H__
+#define __CU_COMPLEX_H__
+
+//struct used in the julia function to represent complex numbers on the complex plane
+template <typename T>
+struct cuComplexT {
+    T   r;
+    T   i;
+    cuComplexT( T a, T b ) : r(a), i(b)  {}
+    T magnitude2( void ) { return r * r + i * i; }
+    cuComplexT operator*(const cuComplexT& a) {
+        return cuComplexT(r*a.r - i*a.i, i*a.r + r*a.i);
+    }
+    cuComplexT operator+(const cuComplexT& a) {
+        return cuComplexT(r+a.r, i+a.i);
+    }
+};
+
+//the original single precision type used by julia()
+typedef cuComplexT<float> cuComplex;
+
+#endif  // __CU_COMPLEX_H__
@@ -0,0 +1,166 @@
+/* File:     distance.h
+ *
+ * Purpose:  exterior distance estimation. Next to z the escape loop also iterates
+ *           the derivative z' = dz/dz_0 (z'_{n+1} = 2 z_n z'_n, z'_0 = 1), and when
+ *           the pixel escapes
+ *
+ *               d = 0.5 |z| log|z| / |z'|
+ *
+ *           estimates its distance to the julia set in complex plane units.
+ *
+ *           That tells where antialiasing is worth it: escaped pixels closer to the set
+ *           than DE_AA_RADIUS pixel widths are candidates, everything further out keeps
+ *           its single sample. Pixels that never escaped have no estimate and keep
+ *           theirs too, the edge is smoothed from its escaped side. A supersampled pixel
+ *           first takes the 4 corner samples of its DE_SAMPLES x DE_SAMPLES grid and
+ *           only fills in the rest of the grid when they disagree.
+ *
+ *           The pixels next to the set are also the ones that take the most
+ *           iterations: on the default dust-like set sampling every candidate costs
+ *           about 6 times the single sample pass. So the candidates are taken
+ *           cheapest first, up to the escape count at which their corner samples
+ *           would use up DE_AA_BUDGET of the single sample iterations
+ *           (de_sample_cutoff), which keeps the whole render close to one sample
+ *           per pixel. The budget only counts the corners at the pixel's own cost,
+ *           deeper sub-pixel orbits and refilled grids bring the measured total to
+ *           about 1 + 2.5 x DE_AA_BUDGET.
+ *
+ */
+
+#ifndef __DISTANCE_H__
+#define __DISTANCE_H__
+
+#include <cmath>
+#include <vector>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "viewport.h"
+#include "julia_precision.h"
+
+#define DE_SAMPLES 4        //samples per side for the pixels near the set
+#define DE_AA_RADIUS 0.5f   //supersample when the estimate is below this many pixel widths
+#define DE_AA_BUDGET 0.1   //corner samples may cost this fraction of the single sample iterations
+
+struct DistanceStats {
+    long long   supersampled;       //pixels that took more than one sample
+    long long   refined;            //of those, pixels whose corner samples disagreed
+    int         cutoff;             //highest escape count that was still supersampled
+    long long   base_iterations;    //iterations of the one sample per pixel pass
+    long long   extra_iterations;   //iterations of all the extra samples
+    double      base_seconds;       //time of the one sample pass
+    double      sample_seconds;     //time of the supersampling pass
+};
+
+//escape_orbit() watch that carries the derivative z' = 2 z z' along, z from before the step
+//z' is kept in double, 200 doublings of a float would overflow
+struct DerivativeWatch {
+    double  dr, di;
+
+    DerivativeWatch( void ) : dr(1.0), di(0.0) {}
+
+    void before_step( const cuComplex &a ) {
+        double ndr = 2.0 * (a.r * dr - a.i * di);
+        double ndi = 2.0 * (a.r * di + a.i * dr);
+        dr = ndr;
+        di = ndi;
+    }
+
+    bool captured( const cuComplex & ) { return false; }
+};
+
+//same escape loop as julia() for the point (jx, jy), returns the same 0/1 value and
+//writes the distance estimate to distance (0 when the point never escaped)
+//iterations (optional) gets the number of iterations run added to it
+inline int julia_de( float jx, float jy, float *distance, long long *iterations = NULL ) {
+    cuComplex a(jx, jy);
+    DerivativeWatch watch;
+    int n;
+    bool escaped = escape_orbit(a, MAX_ITER, watch, n);
+    if (iterations)
+        *iterations += n;
+    if (!escaped) {
+        *distance = 0.0f;
+        return 1;
+    }
+    double mz = sqrt((double)a.magnitude2());
+    *distance = (float)(0.5 * mz * log(mz) / sqrt(watch.dr * watch.dr + watch.di * watch.di));
+    return 0;
+}
+
+//plain julia() loop for a point, the extra samples need no estimate
+inline int julia_sample( float jx, float jy, long long *iterations = NULL ) {
+    cuComplex a(jx, jy);
+    NoWatch watch;
+    int n;
+    bool escaped = escape_orbit(a, MAX_ITER, watch, n);
+    if (iterations)
+        *iterations += n;
+    return escaped ? 0 : 1;
+}
+
+//true when the pixel at offset escaped close enough to the set to be worth more samples,
+//vals, dist and iters hold the 0/1 value, estimate and escape count of the single sample pass
+inline bool de_candidate( const int *vals, const float *dist, int offset, float limit ) {
+    return vals[offset] == 0 && dist[offset] < limit;
+}
+
+//highest escape count for which the corner samples of all candidates with that count
+//or less stay within DE_AA_BUDGET of base_iterations, a corner sample costing about
+//as much as the pixel's own sample. 0 when not even the cheapest fit
+inline int de_sample_cutoff( const int *vals, const float *dist, const int *iters,
+                             float limit, long long base_iterations ) {
+    std::vector<long long> count(MAX_ITER + 1, 0);
+    for (int offset=0; offset<DIM*DIM; offset++) {
+        if (de_candidate(vals, dist, offset, limit))
+            count[iters[offset]]++;
+    }
+
+    const double budget = DE_AA_BUDGET * base_iterations;
+    double cost = 0.0;
+    int cutoff = 0;
+    for (int n=1; n<=MAX_ITER; n++) {
+        cost += 4.0 * n * count[n];
+        if (cost > budget)
+            break;
+        cutoff = n;
+    }
+    return cutoff;
+}
+
+//true when pixel (x, y) gets supersampled: a candidate that escaped within cutoff iterations
+inline bool de_needs_samples( const int *vals, const float *dist, const int *iters,
+                              int x, int y, float limit, int cutoff ) {
+    int offset = x + y * DIM;
+    return de_candidate(vals, dist, offset, limit) && iters[offset] <= cutoff;
+}
+
+//sample (i, j) of the DE_SAMPLES x DE_SAMPLES grid of pixel (x, y)
+inline int de_grid_sample( int x, int y, int i, int j, long long *iterations ) {
+    float jx = pixel_coord(x + ((i + 0.5f) / DE_SAMPLES - 0.5f));
+    float jy = pixel_coord(y + ((j + 0.5f) / DE_SAMPLES - 0.5f));
+    return julia_sample(jx, jy, iterations);
+}
+
+//fraction of the grid samples of pixel (x, y) that never escape, the corners are
+//taken first and when they agree the pixel counts as uniform, refined says if the
+//rest of the grid was needed and iterations gets the iterations run added to it
+inline float de_coverage( int x, int y, bool *refined, long long *iterations ) {
+    const int last = DE_SAMPLES - 1;
+    int corners = de_grid_sample(x, y, 0, 0, iterations) + de_grid_sample(x, y, last, 0, iterations)
+                + de_grid_sample(x, y, 0, last, iterations) + de_grid_sample(x, y, last, last, iterations);
+    *refined = corners != 0 && corners != 4;
+    if (!*refined)
+        return corners / 4.0f;
+
+    int inside = corners;
+    for (int j=0; j<DE_SAMPLES; j++) {
+        for (int i=0; i<DE_SAMPLES; i++) {
+            if ((i == 0 || i == last) && (j == 0 || j == last))
+                continue; //corner, already taken
+            inside += de_grid_sample(x, y, i, j, iterations);
+        }
+    }
+    return (float)inside / (DE_SAMPLES * DE_SAMPLES);
+}
+
+#endif  // __DISTANCE_H__
@@ -0,0 +1,160 @@
+/* File:     double_double.h
+ *
+ * Purpose:  double-double numbers (an unevaluated sum hi + lo of two doubles)
+ *           which give about 106 bits of mantissa using only double hardware.
+ *           Used by julia_t<dd_real> for zooms deeper than double can resolve.
+ *
+ *           The error free transforms below rely on every operation being rounded
+ *           on its own, the Makefile builds with -ffp-contract=off for that.
+ *
+ */
+
+#ifndef __DOUBLE_DOUBLE_H__
+#define __DOUBLE_DOUBLE_H__
+
+#include <algorithm>
+#include <cctype>
+
+struct dd_real {
+    double  hi;
+    double  lo;
+    dd_real( void ) : hi(0.0), lo(0.0) {}
+    dd_real( double h ) : hi(h), lo(0.0) {}
+    dd_real( double h, double l ) : hi(h), lo(l) {}
+};
+
+//s + e == a + b exactly, for any a and b
+inline dd_real two_sum( double a, double b ) {
+    double s = a + b;
+    double bb = s - a;
+    double e = (a - (s - bb)) + (b - bb);
+    return dd_real(s, e);
+}
+
+//same as two_sum but only valid when |a| >= |b|
+inline dd_real quick_two_sum( double a, double b ) {
+    double s = a + b;
+    double e = b - (s - a);
+    return dd_real(s, e);
+}
+
+//splits a into two 26 bit halves (Dekker) so their products are exact
+inline void dd_split( double a, double &hi, double &lo ) {
+    const double splitter = 134217729.0; //2^27 + 1
+    double t = splitter * a;
+    hi = t - (t - a);
+    lo = a - hi;
+}
+
+//p + e == a * b exactly
+inline dd_real two_prod( double a, double b ) {
+    double p = a * b;
+    double ah, al, bh, bl;
+    dd_split(a, ah, al);
+    dd_split(b, bh, bl);
+    double e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+    return dd_real(p, e);
+}
+
+inline dd_real operator+( const dd_real &a, const dd_real &b ) {
+    dd_real s = two_sum(a.hi, b.hi);
+    dd_real t = two_sum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = quick_two_sum(s.hi, s.lo);
+    s.lo += t.lo;
+    return quick_two_sum(s.hi, s.lo);
+}
+
+inline dd_real operator-( const dd_real &a ) {
+    return dd_real(-a.hi, -a.lo);
+}
+
+inline dd_real operator-( const dd_real &a, const dd_real &b ) {
+    return a + (-b);
+}
+
+inline dd_real operator*( const dd_real &a, const dd_real &b ) {
+    dd_real p = two_prod(a.hi, b.hi);
+    p.lo += a.hi * b.lo + a.lo * b.hi;
+    return quick_two_sum(p.hi, p.lo);
+}
+
+//long division, three quotient digits are enough for full dd accuracy
+inline dd_real operator/( const dd_real &a, const dd_real &b ) {
+    double q1 = a.hi / b.hi;
+    dd_real r = a - b * dd_real(q1);
+    double q2 = r.hi / b.hi;
+    r = r - b * dd_real(q2);
+    double q3 = r.hi / b.hi;
+    return quick_two_sum(q1, q2) + dd_real(q3);
+}
+
+inline bool operator>( const dd_real &a, const dd_real &b ) {
+    return a.hi > b.hi || (a.hi == b.hi && a.lo > b.lo);
+}
+
+inline bool operator<( const dd_real &a, const dd_real &b ) {
+    return b > a;
+}
+
+inline double to_double( const dd_real &a ) {
+    return a.hi + a.lo;
+}
+
+//parses a decimal number like "-0.7436438870371587e-2" without going through
+//a double first, so centres can be given with more than 17 significant digits.
+//Like strtod, end (if given) is set to the first character not used, or to s
+//when there is no number at all
+inline dd_real dd_from_string( const char *s, const char **end = NULL ) {
+    const char *start = s;
+    dd_real value;
+    bool negative = false;
+    bool digits = false;
+    int exponent = 0;
+
+    if (*s == '-' || *s == '+')
+        negative = (*s++ == '-');
+    for (; isdigit((unsigned char)*s); s++) {
+        value = value * dd_real(10.0) + dd_real(*s - '0');
+        digits = true;
+    }
+    if (*s == '.') {
+        for (s++; isdigit((unsigned char)*s); s++) {
+            value = value * dd_real(10.0) + dd_real(*s - '0');
+            exponent--;
+            digits = true;
+        }
+    }
+    if (!digits) {
+        if (end)
+            *end = start;
+        return dd_real();
+    }
+    //an exponent without digits is not part of the number
+    const char *mantissa_end = s;
+    if (*s == 'e' || *s == 'E') {
+        s++;
+        bool negexp = false;
+        if (*s == '-' || *s == '+')
+            negexp = (*s++ == '-');
+        if (!isdigit((unsigned char)*s)) {
+            s = mantissa_end;
+        } else {
+            //past a few hundred the value is already 0 or inf, cap so e can not overflow
+            int e = 0;
+            for (; isdigit((unsigned char)*s); s++)
+                e = std::min(e * 10 + (*s - '0'), 1000);
+            exponent += negexp ? -e : e;
+        }
+    }
+    if (end)
+        *end = s;
+
+    for (; exponent > 0; exponent--)
+        value = value * dd_real(10.0);
+    for (; exponent < 0; exponent++)
+        value = value / dd_real(10.0);
+    return negative ? -value : value;
+}
+
+#endif  // __DOUBLE_DOUBLE_H__
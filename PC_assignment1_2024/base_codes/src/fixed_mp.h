@@ -0,0 +1,284 @@
+/* File:     fixed_mp.h
+ *
+ * Purpose:  multi-precision fixed-point numbers for reference orbits deeper than
+ *           double-double can place, no GMP needed. A FixedMP<N> is a sign and N
+ *           32 bit limbs of magnitude, limb N-1 is the integer part and the other
+ *           N-1 limbs are the fraction, so it carries 32*(N-1) bits after the point.
+ *           Orbits never leave |z|^2 <= BAILOUT before we stop, so 32 integer bits
+ *           are more than enough and every operation simply truncates.
+ *
+ *           The orbit loop only needs squarings (z*z + c with the imaginary part
+ *           done as (r+i)^2 - r^2 - i^2) and squaring computes each cross product
+ *           once, which is about half the limb multiplies of a general product.
+ *
+ */
+
+#ifndef __FIXED_MP_H__
+#define __FIXED_MP_H__
+
+#include <stdint.h>
+#include <cctype>
+#include <cmath>
+#include <vector>
+#include "fractal.h"
+
+template <int N>
+struct FixedMP {
+    uint32_t    limb[N];    //magnitude, least significant limb first
+    bool        neg;
+
+    FixedMP( void ) : neg(false) {
+        for (int k=0; k<N; k++)
+            limb[k] = 0;
+    }
+};
+
+//compares magnitudes, returns -1, 0 or 1
+template <int N>
+inline int mag_cmp( const FixedMP<N> &a, const FixedMP<N> &b ) {
+    for (int k=N-1; k>=0; k--) {
+        if (a.limb[k] != b.limb[k])
+            return a.limb[k] < b.limb[k] ? -1 : 1;
+    }
+    return 0;
+}
+
+//out = |a| + |b|
+template <int N>
+inline void mag_add( const FixedMP<N> &a, const FixedMP<N> &b, FixedMP<N> &out ) {
+    uint64_t carry = 0;
+    for (int k=0; k<N; k++) {
+        uint64_t t = (uint64_t)a.limb[k] + b.limb[k] + carry;
+        out.limb[k] = (uint32_t)t;
+        carry = t >> 32;
+    }
+}
+
+//out = |a| - |b|, needs |a| >= |b|
+template <int N>
+inline void mag_sub( const FixedMP<N> &a, const FixedMP<N> &b, FixedMP<N> &out ) {
+    int64_t borrow = 0;
+    for (int k=0; k<N; k++) {
+        int64_t t = (int64_t)a.limb[k] - b.limb[k] - borrow;
+        borrow = t < 0;
+        out.limb[k] = (uint32_t)(t + (borrow << 32));
+    }
+}
+
+template <int N>
+inline FixedMP<N> operator+( const FixedMP<N> &a, const FixedMP<N> &b ) {
+    FixedMP<N> out;
+    if (a.neg == b.neg) {
+        mag_add(a, b, out);
+        out.neg = a.neg;
+    } else if (mag_cmp(a, b) >= 0) {
+        mag_sub(a, b, out);
+        out.neg = a.neg;
+    } else {
+        mag_sub(b, a, out);
+        out.neg = b.neg;
+    }
+    return out;
+}
+
+template <int N>
+inline FixedMP<N> operator-( const FixedMP<N> &a ) {
+    FixedMP<N> out = a;
+    out.neg = !a.neg;
+    return out;
+}
+
+template <int N>
+inline FixedMP<N> operator-( const FixedMP<N> &a, const FixedMP<N> &b ) {
+    return a + (-b);
+}
+
+//general product, only used outside the orbit loop
+//the full 2N limb product is formed and limbs N-1 .. 2N-2 are kept, which puts the point back in place
+template <int N>
+inline FixedMP<N> operator*( const FixedMP<N> &a, const FixedMP<N> &b ) {
+    uint32_t col[2*N];
+    for (int k=0; k<2*N; k++)
+        col[k] = 0;
+
+    for (int i=0; i<N; i++) {
+        uint64_t carry = 0;
+        for (int j=0; j<N; j++) {
+            uint64_t t = (uint64_t)a.limb[i] * b.limb[j] + col[i+j] + carry;
+            col[i+j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        col[i+N] = (uint32_t)carry;
+    }
+
+    FixedMP<N> out;
+    for (int k=0; k<N; k++)
+        out.limb[k] = col[k + N-1];
+    out.neg = a.neg != b.neg;
+    return out;
+}
+
+//a * a with every cross product a_i a_j (i < j) computed once and doubled
+template <int N>
+inline FixedMP<N> sqr( const FixedMP<N> &a ) {
+    uint32_t col[2*N];
+    for (int k=0; k<2*N; k++)
+        col[k] = 0;
+
+    //cross products
+    for (int i=0; i<N; i++) {
+        uint64_t carry = 0;
+        for (int j=i+1; j<N; j++) {
+            uint64_t t = (uint64_t)a.limb[i] * a.limb[j] + col[i+j] + carry;
+            col[i+j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        col[i+N] = (uint32_t)carry;
+    }
+
+    //double them
+    uint32_t top = 0;
+    for (int k=0; k<2*N; k++) {
+        uint32_t next = col[k] >> 31;
+        col[k] = (col[k] << 1) | top;
+        top = next;
+    }
+
+    //add the squares on the diagonal
+    uint64_t carry = 0;
+    for (int i=0; i<N; i++) {
+        uint64_t sq = (uint64_t)a.limb[i] * a.limb[i];
+        uint64_t t = (uint64_t)col[2*i] + (uint32_t)sq + carry;
+        col[2*i] = (uint32_t)t;
+        t = (uint64_t)col[2*i+1] + (sq >> 32) + (t >> 32);
+        col[2*i+1] = (uint32_t)t;
+        carry = t >> 32;
+    }
+
+    FixedMP<N> out;
+    for (int k=0; k<N; k++)
+        out.limb[k] = col[k + N-1];
+    return out;
+}
+
+//exact conversion of a double (bits below the last limb are dropped)
+template <int N>
+inline FixedMP<N> fixed_from_double( double d ) {
+    FixedMP<N> out;
+    out.neg = d < 0;
+    double m = fabs(d);
+    double ip = floor(m);
+    out.limb[N-1] = (uint32_t)ip;
+    m -= ip;
+    for (int k=N-2; k>=0 && m != 0.0; k--) {
+        m *= 4294967296.0; //2^32, exact
+        ip = floor(m);
+        out.limb[k] = (uint32_t)ip;
+        m -= ip;
+    }
+    return out;
+}
+
+template <int N>
+inline double to_double( const FixedMP<N> &a ) {
+    double d = 0.0;
+    for (int k=0; k<N; k++)
+        d = d / 4294967296.0 + a.limb[k];
+    return a.neg ? -d : d;
+}
+
+//|a| = |a| * m + add for small m, returns the overflow out of the integer limb
+template <int N>
+inline uint32_t mag_mul_small( FixedMP<N> &a, uint32_t m, uint32_t add ) {
+    uint64_t carry = add;
+    for (int k=0; k<N; k++) {
+        uint64_t t = (uint64_t)a.limb[k] * m + carry;
+        a.limb[k] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    return (uint32_t)carry;
+}
+
+//|a| = |a| / m for small m
+template <int N>
+inline void mag_div_small( FixedMP<N> &a, uint32_t m ) {
+    uint64_t rem = 0;
+    for (int k=N-1; k>=0; k--) {
+        uint64_t t = (rem << 32) | a.limb[k];
+        a.limb[k] = (uint32_t)(t / m);
+        rem = t % m;
+    }
+}
+
+//parses a decimal number like "-0.7436438870371587e-2" to the full precision of the type
+template <int N>
+inline FixedMP<N> fixed_from_string( const char *s ) {
+    FixedMP<N> out;
+    if (*s == '-' || *s == '+')
+        out.neg = (*s++ == '-');
+
+    for (; isdigit((unsigned char)*s); s++)
+        out.limb[N-1] = out.limb[N-1] * 10 + (*s - '0');
+
+    //fraction digits are folded in from the last one: f = (f + digit) / 10
+    std::vector<int> digits;
+    if (*s == '.') {
+        for (s++; isdigit((unsigned char)*s); s++)
+            digits.push_back(*s - '0');
+    }
+    FixedMP<N> frac;
+    for (int k=(int)digits.size()-1; k>=0; k--) {
+        frac.limb[N-1] += digits[k];
+        mag_div_small(frac, 10);
+    }
+    for (int k=0; k<N-1; k++)
+        out.limb[k] = frac.limb[k];
+
+    if (*s == 'e' || *s == 'E') {
+        s++;
+        bool negexp = false;
+        if (*s == '-' || *s == '+')
+            negexp = (*s++ == '-');
+        int e = 0;
+        for (; isdigit((unsigned char)*s); s++)
+            e = e * 10 + (*s - '0');
+        for (; e > 0; e--) {
+            if (negexp)
+                mag_div_small(out, 10);
+            else
+                mag_mul_small(out, 10, 0);
+        }
+    }
+    return out;
+}
+
+//iterates z = z*z + c from (sr, si) for up to max_iter steps and appends every z
+//rounded to double to zr/zi (z_0 included), returns the iteration it escaped at
+//or max_iter when it never did
+template <int N>
+inline int iterate_fixed_orbit( const FixedMP<N> &sr, const FixedMP<N> &si, int max_iter,
+                                std::vector<double> &zr, std::vector<double> &zi ) {
+    const FixedMP<N> cr = fixed_from_double<N>(JULIA_CR);
+    const FixedMP<N> ci = fixed_from_double<N>(JULIA_CI);
+    FixedMP<N> r = sr, i = si;
+    FixedMP<N> r2 = sqr(r), i2 = sqr(i);
+
+    zr.assign(1, to_double(r));
+    zi.assign(1, to_double(i));
+    for (int n=0; n<max_iter; n++) {
+        FixedMP<N> s = sqr(r + i);
+        r = r2 - i2 + cr;
+        i = s - r2 - i2 + ci;
+        zr.push_back(to_double(r));
+        zi.push_back(to_double(i));
+
+        //the squares are needed for the next step anyway, so the bailout test is free
+        r2 = sqr(r);
+        i2 = sqr(i);
+        if (to_double(r2) + to_double(i2) > BAILOUT)
+            return n + 1;
+    }
+    return max_iter;
+}
+
+#endif  // __FIXED_MP_H__
@@ -2,250 +2,643 @@
  *
  * Purpose:  compute the Julia set fractals
  *
- * Compile:  g++ -g -Wall -fopenmp -o fractal fractal.cpp -lglut -lGL
- * Run:      ./fractal
+ * Compile:  make, or by hand
+ *           g++ -g -Wall -ffp-contract=off -fopenmp -I ../common -o fractal fractal.cpp progressive_view.cpp -lglut -lGL
+ * Run:      ./fractal [options], see main() for the list
  *
  */
 
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <climits>
 #include "../common/cpu_bitmap.h"
 #include <omp.h>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "viewport.h"
+#include "julia_precision.h"
+#include "perturb.h"
+#include "julia_periodic.h"
+#include "attractor.h"
+#include "mariani_silver.h"
+#include "boundary_trace.h"
+#include "progressive.h"
+#include "progressive_view.h"
+#include "interval.h"
+#include "distance.h"
+#include "antialias.h"
+#include "smooth.h"
+#include "palette.h"
+#include "hsl.h"
+#include "histogram.h"
+#include "work_steal.h"
+#include "partition.h"
+#include "render_driver.h"
+#include "autotune.h"
+#include "column_tiles.h"
+#include "julia_simd.h"
+#include "cpu_dispatch.h"
 using namespace std;
 
-#define DIM 768 //defines the image dimensions width and height
 /*Uncomment the follow
 ing line for visualization of the bitmap*/
-#define NUM_THREADS 16
-
 #define DISPLAY 1
 
 
-//struct used in the julia function to represent complex numbers on the complex plane
-struct cuComplex {
-    float   r;
-    float   i;
-    cuComplex( float a, float b ) : r(a), i(b)  {}
-    float magnitude2( void ) { return r * r + i * i; }
-    cuComplex operator*(const cuComplex& a) {
-        return cuComplex(r*a.r - i*a.i, i*a.r + r*a.i);
-    }
-    cuComplex operator+(const cuComplex& a) {
-        return cuComplex(r+a.r, i+a.i);
-    }
-};
-
 //calculates the membership of a point in the complex plane within the Julia set
 //x is the x-coordinate of the pixel in image, y is the y-coordinate of the pixel in image
 int julia( int x, int y ) { 
-    const float scale = 1.5;
+    const float scale = JULIA_SCALE;
     //calculates sacled versions of x and y -> transforms the pixel coordinates into comlpex plane coordinates suitable for the julia set formula
     float jx = scale * (float)(DIM/2 - x)/(DIM/2);
     float jy = scale * (float)(DIM/2 - y)/(DIM/2);
 
-    cuComplex c(-0.8, 0.156);
+    cuComplex c(JULIA_CR, JULIA_CI);
     // cuComplex c(-0.5, -0.56); //defines object c -> changing this will give us a different julia set
     cuComplex a(jx, jy);// defines object a -> created using the scaled coordinates (jx, jy) asscoiated with the pixel (x, y)
 
     //iterates a max of 200 times to determine if the point is in the julia set
     int i = 0;
-    for (i=0; i<200; i++) {
+    for (i=0; i<MAX_ITER; i++) {
         a = a * a + c; //a is squared and added with constant c 
-        if (a.magnitude2() > 1000) //squared magnitude of a is compared with 1000 for our divergence check
+        if (a.magnitude2() > BAILOUT) //squared magnitude of a is compared with 1000 for our divergence check
             return 0; //if the magnitude of a is greater than 1000, the point is not in the julia set
     }
 
     return 1; //if the point is in the julia set
 }
 
-/*Parallelize the following function using OpenMP*/
-void kernel_omp_rowwise ( unsigned char *ptr ){
-    int nthreads; //used for collection at the end and to set the number of threads in the par region
-    int tid, tthreads, y;
-    // int juliaValue;
-    omp_set_num_threads(NUM_THREADS); //set for 8 for now 768/8 = 96
-    #pragma omp parallel private(tid, y)
-    {
-        tthreads = NUM_THREADS; //get number of threads in the par region
-        tid = omp_get_thread_num(); //get the unique thread ids
+//renders the viewport row by row with julia_t<T>
+template <typename T>
+void render_view ( unsigned char *ptr, const Viewport &view ){
+    render( DynamicRows(), [&view](int x, int y) { return julia_t<T>( x, y, view ); }, RgbaWriter( ptr ), NUM_THREADS );
+}
 
-        if(tid == 0){
-            nthreads = tthreads;
-        }
+//renders any viewport in the given precision (see choose_precision for the cheapest safe one)
+void kernel_omp_precision ( unsigned char *ptr, const Viewport &view, Precision prec ){
+    switch (prec) {
+        case PREC_FLOAT:       render_view<float>( ptr, view ); break;
+        case PREC_DOUBLE:      render_view<double>( ptr, view ); break;
+        case PREC_LONG_DOUBLE: render_view<long double>( ptr, view ); break;
+        default:               render_view<dd_real>( ptr, view ); break;
+    }
+}
+
+//deep zoom kernel: one high precision reference orbit for the frame, then the rows are
+//shared out and every pixel only iterates its double precision offset from the reference
+//glitched pixels are collected and fixed afterwards with extra references (resolve_glitches)
+//with use_bla the main reference also gets a BLA table that all threads read to skip iterations
+void kernel_omp_perturb ( unsigned char *ptr, const Viewport &view, bool use_bla, PerturbStats &stats ){
+    ReferenceOrbit ref;
+    compute_reference_orbit( ref, view );
+    BlaTable bla;
+    if (use_bla)
+        build_bla_table( bla, ref.zr, ref.zi, ref.length );
+    std::vector<int> glitched;
+    long long skipped = 0;
+    RgbaWriter writer( ptr );
 
-        for (y=tid; y < DIM ; y = y + tthreads) //distro over rows here
-        {
-            int baseOffset = y * DIM;
-            for (int x=0; x<DIM; x++)//cols here
-            {
-                int offset = x + baseOffset; //offset out calculation
-                    //gathering all the data now
-                int juliaValue = julia( x, y );
-                // cout << juliaValue << endl;
-
-                ptr[offset*4 + 0] = 255 * juliaValue;
-                ptr[offset*4 + 1] = 0;
-                ptr[offset*4 + 2] = 0;
-                ptr[offset*4 + 3] = 255;
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel
+    {
+        std::vector<int> my_glitched; //glitched pixels this thread still owes resolve_glitches, no lock per pixel
+
+        #pragma omp for schedule(dynamic) reduction(+:skipped)
+        for (int y=0; y<DIM; y++) {
+            for (int x=0; x<DIM; x++) {
+                int juliaValue = julia_perturb( x, y, view, ref, use_bla ? &bla : NULL, &skipped );
+                if (juliaValue == PERTURB_GLITCH)
+                    my_glitched.push_back(x + y * DIM);
+                else
+                    writer.write( x, y, juliaValue );
             }
         }
-    }  
 
+        #pragma omp critical
+        glitched.insert(glitched.end(), my_glitched.begin(), my_glitched.end());
+    }
 
- }
+    std::vector<int> results;
+    resolve_glitches( glitched, view, results, stats );
+    stats.bla_skipped = skipped;
+    stats.reference_bits = ref.bits;
+    for (size_t k=0; k<glitched.size(); k++)
+        writer.write( glitched[k] % DIM, glitched[k] / DIM, results[k] );
+}
 
-void kernal_omp_colwise ( unsigned char *ptr ){
-        int nthreads; //used for collection at the end and to set the number of threads in the par region
-    int tid, tthreads, x;
-    // int juliaValue;
-    omp_set_num_threads(NUM_THREADS); //set for 8 for now 768/8 = 96
-    #pragma omp parallel private(tid, x)
-    {
-        tthreads = NUM_THREADS; //get number of threads in the par region
-        tid = omp_get_thread_num(); //get the unique thread ids
-        //set our master theread responsible for cleanup and distro
-        // #pragma omp critical
-        if(tid == 0){
-            nthreads = tthreads;
+//row parallel kernel with a runtime iteration cap and optional periodicity checking
+//returns the total number of iterations run over the image
+long long kernel_omp_periodic ( unsigned char *ptr, int max_iter, bool periodicity ){
+    long long total = 0;
+    RgbaWriter writer( ptr );
+
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel for schedule(dynamic) reduction(+:total)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++) {
+            int iterations;
+            writer.write( x, y, julia_periodic( x, y, max_iter, periodicity, &iterations ) );
+            total += iterations;
         }
-        for (x=tid; x < DIM ; x = x + tthreads) //distro over rows here
-        {
-            int baseOffset = x * DIM;
-            for (int y=0; y<DIM; y++)//cols here
-            {
-                int offset = y + baseOffset; //offset out calculation
-                    //gathering all the data now
-                int juliaValue = julia( y, x );
-                // cout << juliaValue << endl;
-
-                ptr[offset*4 + 0] = 255 * juliaValue;
-                ptr[offset*4 + 1] = 0;
-                ptr[offset*4 + 2] = 0;
-                ptr[offset*4 + 3] = 255;
-            }
+    }
+    return total;
+}
+
+//row parallel kernel that stops interior pixels once they are captured by the
+//precomputed attracting cycle, returns the total number of iterations run
+long long kernel_omp_attractor ( unsigned char *ptr, int max_iter, const AttractingCycle &cyc ){
+    long long total = 0;
+    RgbaWriter writer( ptr );
+
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel for schedule(dynamic) reduction(+:total)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++) {
+            int iterations;
+            writer.write( x, y, julia_attractor( x, y, max_iter, cyc, &iterations ) );
+            total += iterations;
         }
-    }  
- }
+    }
+    return total;
+}
 
- void kernal_omp_rowblock (unsigned char *ptr)
- {
-    int tid, rows_per_thread, start_row,end_row,y;
-    int remainder = DIM % NUM_THREADS;
+//true when the viewport is centred on 0, then pixel (x, y) and (DIM-x, DIM-y) map to z and -z
+//and since f(-z) = f(z) exactly (also in floating point) both pixels get the same value
+bool view_is_symmetric ( const Viewport &view ){
+    return view.cx.hi == 0.0 && view.cx.lo == 0.0 && view.cy.hi == 0.0 && view.cy.lo == 0.0;
+}
+
+//computes rows 0 .. DIM/2 (plus column 0 below them, which has no partner since pixel DIM
+//does not exist) and fills the other half with a point reflected copy
+template <typename T>
+void render_view_symmetric ( unsigned char *ptr, const Viewport &view ){
+    RgbaWriter writer( ptr );
     omp_set_num_threads(NUM_THREADS);
-    #pragma omp parallel private(tid, rows_per_thread, start_row, end_row, y)
+    #pragma omp parallel
     {
-        tid = omp_get_thread_num();
-        int tthreads = omp_get_num_threads();
-
-        rows_per_thread = DIM/tthreads;
-        start_row = tid * rows_per_thread;
-        end_row = start_row + rows_per_thread -1; 
-        //#pragma omp critical
-        //cout << "Thread " << tid << " is processing from starting at row: " << start_row << " uptill row: " << end_row << endl;
-
-        if(tid == NUM_THREADS -1 && remainder != 0){
-            end_row += remainder;
-            //#pragma omp critical
-            //cout << " !!!!! Thread " << tid << " is processing from starting at row: " << start_row << " uptill row: " << end_row << endl;
+        #pragma omp for schedule(dynamic)
+        for (int y=0; y<=DIM/2; y++) {
+            for (int x=0; x<DIM; x++)
+                writer.write( x, y, julia_t<T>( x, y, view ) );
         }
 
-        for(y = start_row; y <= end_row ; y++){
-            int baseOffset = y * DIM;
-            for(int x = 0; x < DIM ; x++){
-                int offset = x + baseOffset; //offset out calculation
-                //gathering all the data now
-                int juliaValue = julia( x, y );
-                // cout << juliaValue << endl;
-                ptr[offset*4 + 0] = 255 * juliaValue;
-                ptr[offset*4 + 1] = 0;
-                ptr[offset*4 + 2] = 0;
-                ptr[offset*4 + 3] = 255;
-            }
+        #pragma omp for schedule(dynamic)
+        for (int y=DIM/2+1; y<DIM; y++)
+            writer.write( 0, y, julia_t<T>( 0, y, view ) );
+        //implicit barrier, the top half is complete before it is copied
+
+        //whole rgba pixels as 32 bit words, row DIM-y read backwards into row y
+        unsigned int *pixels = (unsigned int *)ptr;
+        #pragma omp for schedule(static)
+        for (int y=DIM/2+1; y<DIM; y++) {
+            unsigned int *dst = pixels + y * DIM;
+            const unsigned int *src = pixels + (DIM - y) * DIM + DIM;
+            for (int x=1; x<DIM; x++)
+                dst[x] = src[-x];
         }
     }
- }
+}
+
+//renders half the image and mirrors the rest when the viewport is centred,
+//otherwise falls back to the full precision kernel, returns whether the symmetry was used
+bool kernel_omp_symmetric ( unsigned char *ptr, const Viewport &view, Precision prec ){
+    if (!view_is_symmetric(view)) {
+        kernel_omp_precision( ptr, view, prec );
+        return false;
+    }
+    switch (prec) {
+        case PREC_FLOAT:       render_view_symmetric<float>( ptr, view ); break;
+        case PREC_DOUBLE:      render_view_symmetric<double>( ptr, view ); break;
+        case PREC_LONG_DOUBLE: render_view_symmetric<long double>( ptr, view ); break;
+        default:               render_view_symmetric<dd_real>( ptr, view ); break;
+    }
+    return true;
+}
+
+//the original kernels, all through render() from render_driver.h
+//julia() wrapped in a type so every render() instantiation calls it directly
+struct JuliaPixel {
+    int operator()( int x, int y ) const { return julia( x, y ); }
+};
+
+//rows dealt out cyclically, thread tid takes rows tid, tid + NUM_THREADS, ...
+void kernel_omp_rowwise ( unsigned char *ptr ){
+    render( CyclicRows(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//columns dealt out cyclically and walked top to bottom, every store is a row apart
+void kernal_omp_colwise ( unsigned char *ptr ){
+    render( CyclicCols(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//one block of DIM / NUM_THREADS rows per thread
+void kernal_omp_rowblock ( unsigned char *ptr ){
+    render( BlockRows(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//one block of DIM / NUM_THREADS columns per thread
+void kernal_omp_colblock ( unsigned char *ptr ){
+    render( BlockCols(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//column blocks computed into transposed thread local tiles and written back a cache line at a time
+void kernel_omp_colblock_tiled ( unsigned char *ptr ){
+    column_tiles( JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//the pixel loop as one omp for collapse(2) schedule(static)
+void kernal_omp_for ( unsigned char *ptr ){
+    render( CollapsedPixels(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//tile_w x tile_h tiles dealt out cyclically over threads threads
+void kernel_omp_blockcyclic ( unsigned char *ptr, int tile_w, int tile_h, int threads ){
+    render( BlockCyclic2D( tile_w, tile_h ), JuliaPixel(), RgbaWriter( ptr ), threads );
+}
+
+//rows handed out on demand
+void kernel_omp_dynamic ( unsigned char *ptr ){
+    render( DynamicRows(), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+}
+
+//the same loop on a single thread
+void kernel_serial ( unsigned char *ptr ){
+    render( BlockRows(), JuliaPixel(), RgbaWriter( ptr ), 1 );
+}
+
+//runs one vector of the julia kernel for the chosen isa level starting at pixel (x0, y)
+void julia_strip ( Isa isa, int x0, int y, int *values ){
+    switch (isa) {
+        case ISA_AVX512: julia_avx512( x0, y, values ); break;
+        case ISA_AVX2:   julia_avx2( x0, y, values ); break;
+        case ISA_SSE2:   julia_sse2( x0, y, values ); break;
+        default:         values[0] = julia( x0, y ); break;
+    }
+}
+
+//row parallel kernel that evaluates a whole vector of pixels per julia call
+//isa picks the vector width, it must be one that isa_supported() says this cpu can run
+void kernel_omp_simd ( unsigned char *ptr, Isa isa ){
+    int lanes = isa_lanes[isa];
+    RgbaWriter writer( ptr );
 
-  void kernal_omp_colblock (unsigned char *ptr)
- {
-    int tid, cols_per_thread, start_col,end_col,x;
-    int remainder = DIM % NUM_THREADS;
     omp_set_num_threads(NUM_THREADS);
-    #pragma omp parallel private(tid, cols_per_thread, start_col, end_col, x)
-    {
-        tid = omp_get_thread_num();
-        int tthreads = omp_get_num_threads();
-
-        cols_per_thread = DIM/tthreads;
-        start_col = tid * cols_per_thread;
-        end_col = start_col + cols_per_thread -1; 
-        //#pragma omp critical
-        //cout << "Thread " << tid << " is processing from starting at row: " << start_row << " uptill row: " << end_row << endl;
-
-        if(tid == NUM_THREADS -1 && remainder != 0){
-            end_col += remainder;
-            //#pragma omp critical
-            //cout << " !!!!! Thread " << tid << " is processing from starting at row: " << start_row << " uptill row: " << end_row << endl;
+    #pragma omp parallel for schedule(dynamic)
+    for (int y=0; y<DIM; y++) {
+        int values[AVX512_LANES];
+        int x = 0;
+        for (; x + lanes <= DIM; x += lanes) { //full vectors
+            julia_strip( isa, x, y, values );
+
+            for (int l=0; l<lanes; l++)
+                writer.write( x + l, y, values[l] );
         }
+        for (; x<DIM; x++) //tail of the row when DIM is not a multiple of the width
+            writer.write( x, y, julia( x, y ) );
+    }
+ }
+
+//Mariani-Silver subdivision on the full view, rectangles with a uniform border and an
+//interval proof for their inside are filled without calling julia(), returns the
+//number of julia() calls made
+long long kernel_omp_mariani_silver ( unsigned char *ptr ){
+    int *vals = new int[DIM*DIM];
+    omp_set_num_threads(NUM_THREADS);
+    long long calls = mariani_silver( vals, [](int x, int y) { return julia( x, y ); } );
+    render( BlockRows(), [vals](int x, int y) { return vals[x + y * DIM]; }, RgbaWriter( ptr ), NUM_THREADS );
+    delete [] vals;
+    return calls;
+}
 
-        for(x = start_col; x <= end_col ; x++){
-            int baseOffset = x * DIM;
-            for(int y = 0; y < DIM ; y++){
-                int offset = y + baseOffset; //offset out calculation
-                //gathering all the data now
-                int juliaValue = julia( y, x );
-                // cout << juliaValue << endl;
-                ptr[offset*4 + 0] = 255 * juliaValue;
-                ptr[offset*4 + 1] = 0;
-                ptr[offset*4 + 2] = 0;
-                ptr[offset*4 + 3] = 255;
+//boundary tracing on the full view (see boundary_trace.h), serial (one tile)
+//or with the image split into independently traced tiles, returns the number of julia() calls made
+long long kernel_boundary_trace ( unsigned char *ptr, bool tiled ){
+    int *vals = new int[DIM*DIM];
+    omp_set_num_threads(NUM_THREADS);
+    auto fn = [](int x, int y) { return julia( x, y ); };
+    long long calls = tiled ? boundary_trace_tiled( vals, fn ) : boundary_trace( vals, fn );
+    render( BlockRows(), [vals](int x, int y) { return vals[x + y * DIM]; }, RgbaWriter( ptr ), NUM_THREADS );
+    delete [] vals;
+    return calls;
+}
+
+//interval arithmetic pre-pass in front of the usual per pixel loop: tiles with a proven
+//value are filled with a single 32 bit store per pixel, the rest run julia()
+//resolved gets the number of tiles that needed no per pixel work
+void kernel_omp_interval ( unsigned char *ptr, int *resolved ){
+    const int tiles_x = (DIM + IA_TILE - 1) / IA_TILE;
+    TileVerdict *verdicts = new TileVerdict[tiles_x * tiles_x];
+    RgbaWriter writer( ptr );
+    omp_set_num_threads(NUM_THREADS);
+    *resolved = classify_tiles( verdicts );
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t=0; t<tiles_x*tiles_x; t++) {
+        int x0 = (t % tiles_x) * IA_TILE, y0 = (t / tiles_x) * IA_TILE;
+        int x1 = x0 + IA_TILE < DIM ? x0 + IA_TILE : DIM;
+        int y1 = y0 + IA_TILE < DIM ? y0 + IA_TILE : DIM;
+
+        if (verdicts[t] != TILE_UNKNOWN) {
+            int juliaValue = verdicts[t] == TILE_BOUNDED;
+            unsigned char rgba[4] = { (unsigned char)(255 * juliaValue), 0, 0, 255 };
+            unsigned int fill;
+            memcpy(&fill, rgba, 4);
+            for (int y=y0; y<y1; y++) {
+                unsigned int *row = (unsigned int *)ptr + y * DIM;
+                for (int x=x0; x<x1; x++)
+                    row[x] = fill;
             }
+            continue;
+        }
+
+        for (int y=y0; y<y1; y++) {
+            for (int x=x0; x<x1; x++)
+                writer.write( x, y, julia( x, y ) );
         }
     }
- }
-  //responsible for calculating and assigning colors to pixels in the image
- void kernal_omp_for ( unsigned char *ptr ){ //send in a pointer to an array of unsigned chars -> prolly reps image data in memory RGB?
-    #pragma omp parallel for collapse(2) schedule(static)//collapse the two loops into one
-    for (int y=0; y<DIM; y++) { //iterate over the rows of the image
-        for (int x=0; x<DIM; x++) { //iterate over the columns of the image
-            int offset = x + y * DIM; //used to locate memory location of the pixel in the image data array pointed to by ptr
-
-            int juliaValue = julia( x, y ); //determines if the pixel at (x, y) is in the julia set
-            ptr[offset*4 + 0] = 255 * juliaValue; //assigns the color of the pixel based on the juliaValue
-            ptr[offset*4 + 1] = 0; //green
-            ptr[offset*4 + 2] = 0; //blue
-            ptr[offset*4 + 3] = 255; //alpha
+    delete [] verdicts;
+}
+
+//antialiased render driven by the distance estimate: one sample per pixel fills dist
+//(the estimate in complex plane units, 0 for pixels that never escaped), then only the
+//pixels near the set that fit the sample budget are supersampled and get their coverage as red
+void kernel_omp_distance ( unsigned char *ptr, float *dist, DistanceStats &stats ){
+    int *vals = new int[DIM*DIM];
+    int *iters = new int[DIM*DIM];
+    long long supersampled = 0, refined = 0, base_iterations = 0, extra_iterations = 0;
+    const float limit = DE_AA_RADIUS * 2.0f * JULIA_SCALE / DIM;
+    RgbaWriter writer( ptr );
+    omp_set_num_threads(NUM_THREADS);
+
+    double start = omp_get_wtime();
+    #pragma omp parallel for schedule(dynamic) reduction(+:base_iterations)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++) {
+            int offset = x + y * DIM;
+            long long n = 0;
+            vals[offset] = julia_de( pixel_coord(x), pixel_coord(y), &dist[offset], &n );
+            iters[offset] = (int)n;
+            base_iterations += n;
         }
     }
- }
- 
- //responsible for calculating and assigning colors to pixels in the image
- void kernel_serial ( unsigned char *ptr ){ //send in a pointer to an array of unsigned chars -> prolly reps image data in memory RGB?
-    for (int y=0; y<DIM; y++) { //iterate over the rows of the image
-        for (int x=0; x<DIM; x++) { //iterate over the columns of the image
-            int offset = x + y * DIM; //used to locate memory location of the pixel in the image data array pointed to by ptr
-
-            int juliaValue = julia( x, y ); //determines if the pixel at (x, y) is in the julia set
-            ptr[offset*4 + 0] = 255 * juliaValue; //assigns the color of the pixel based on the juliaValue
-            ptr[offset*4 + 1] = 0; //green
-            ptr[offset*4 + 2] = 0; //blue
-            ptr[offset*4 + 3] = 255; //alpha
+    stats.base_seconds = omp_get_wtime() - start;
+
+    start = omp_get_wtime();
+    const int cutoff = de_sample_cutoff( vals, dist, iters, limit, base_iterations );
+    #pragma omp parallel for schedule(dynamic) reduction(+:supersampled,refined,extra_iterations)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++) {
+            int offset = x + y * DIM;
+            float value = vals[offset];
+            if (de_needs_samples( vals, dist, iters, x, y, limit, cutoff )) {
+                bool full;
+                value = de_coverage( x, y, &full, &extra_iterations );
+                supersampled++;
+                refined += full;
+            }
+            writer.write_level( x, y, value );
         }
     }
- }
+    stats.sample_seconds = omp_get_wtime() - start;
+    stats.supersampled = supersampled;
+    stats.refined = refined;
+    stats.cutoff = cutoff;
+    stats.base_iterations = base_iterations;
+    stats.extra_iterations = extra_iterations;
+    delete [] vals;
+    delete [] iters;
+}
+
+//one sample per pixel render followed by jittered supersampling of the edge pixels only,
+//the flagged list is shared out dynamically since edge pixels are the slow ones
+//returns the number of resampled pixels
+long long kernel_omp_antialias ( unsigned char *ptr ){
+    int *vals = new int[DIM*DIM];
+    std::vector<int> flagged;
+    RgbaWriter writer( ptr );
+    omp_set_num_threads(NUM_THREADS);
+
+    //the one sample values are kept for the edge test and as the resample centres
+    render( DynamicRows(), [vals](int x, int y) { return vals[x + y * DIM] = julia( x, y ); }, writer, NUM_THREADS );
+
+    aa_flag_edges( vals, flagged );
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int k=0; k<(int)flagged.size(); k++) {
+        int x = flagged[k] % DIM, y = flagged[k] / DIM;
+        writer.write_level( x, y, aa_resample( x, y, vals[flagged[k]] ) );
+    }
+    delete [] vals;
+    return flagged.size();
+}
+
+//smooth iteration count of every pixel into the float16 buffer smooth
+void kernel_omp_smooth ( half *smooth ){
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel for schedule(dynamic)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++)
+            smooth[x + y * DIM] = float_to_half( julia_smooth( x, y ) );
+    }
+}
+
+//colours a smooth count buffer into the bitmap, red grows with the count so the
+//pixels that never escape are full red like in the 0/1 image
+void smooth_to_rgba ( unsigned char *ptr, const half *smooth ){
+    RgbaWriter writer( ptr );
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel for schedule(static)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++)
+            writer.write_level( x, y, half_to_float( smooth[x + y * DIM] ) );
+    }
+}
+
+//compute half of the split pipeline: only the iteration counts, no rgba stores
+void kernel_omp_iterations ( uint16_t *iters ){
+    omp_set_num_threads(NUM_THREADS);
+    #pragma omp parallel for schedule(dynamic)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++)
+            iters[x + y * DIM] = julia_iterations( x, y );
+    }
+}
+
+//WS_TILE tiles scheduled by work stealing, every thread starts with a contiguous block of them
+void kernel_omp_worksteal ( unsigned char *ptr, WorkStealStats &stats ){
+    WorkStealScheduler sched( NUM_THREADS );
+    ws_submit_image( sched );
+    render( WorkStealTiles( sched, stats ), JuliaPixel(), RgbaWriter( ptr ), sched.threads );
+}
+
+//row ranges of equal predicted cost from a 1/8 resolution preview, one per thread
+//the team actually started, which may be fewer than NUM_THREADS
+//predicted gets each thread's predicted share of the time and actual the time it took
+void kernel_omp_costpartition ( unsigned char *ptr, std::vector<double> &predicted, std::vector<double> &actual ){
+    std::vector<double> row_cost;
+    std::vector<int> bounds;
+    omp_set_num_threads(NUM_THREADS);
+    preview_row_costs( row_cost );
+    render( CostPartitionRows( row_cost, bounds, predicted, actual ), JuliaPixel(), RgbaWriter( ptr ), NUM_THREADS );
+
+    //costs are in iterations, scale them so they add up to the same total time
+    double total_cost = 0.0, total_time = 0.0;
+    for (size_t t=0; t<actual.size(); t++) {
+        total_cost += predicted[t];
+        total_time += actual[t];
+    }
+    for (size_t t=0; t<actual.size(); t++)
+        predicted[t] = total_cost > 0.0 ? predicted[t] / total_cost * total_time : 0.0;
+}
+
+//progressive coarse to fine render of the full view, publishing into ptr after every pass
+//first_pass gets the time until the first (1/16 resolution) image was published
+void kernel_omp_progressive ( unsigned char *ptr, bool strict, ProgressiveRender &pr, double *first_pass ){
+    double start = omp_get_wtime();
+    omp_set_num_threads(NUM_THREADS);
+    progressive_begin( pr, new int[DIM*DIM], strict );
+    while (progressive_next_pass( pr, [](int x, int y) { return julia( x, y ); } )) {
+        publish_progressive( ptr, pr );
+        if (pr.step == PROGRESSIVE_START)
+            *first_pass = omp_get_wtime() - start;
+    }
+    delete [] pr.vals;
+    pr.vals = NULL;
+}
+
+//number of pixels whose rgba value differs between two images
+int count_mismatches ( const unsigned char *a, const unsigned char *b ){
+    int mismatches = 0;
+    for (int offset=0; offset<DIM*DIM; offset++) {
+        if (memcmp(a + offset*4, b + offset*4, 4) != 0)
+            mismatches++;
+    }
+    return mismatches;
+}
+
+//usage: ./fractal [--isa=scalar|sse2|avx2|avx512] [--cx=<re>] [--cy=<im>] [--zoom=<factor>]
+//                 [--precision=auto|float|double|long_double|dd] [--iters=<max iterations>]
+//                 [--progressive[=strict]] [--autotune]
+//without --isa the fastest level the cpu supports is used for the simd kernel
+//--cx/--cy/--zoom move the viewport of the precision kernel, the other kernels always draw the full view
+//--iters sets the iteration cap of the periodicity kernels (the others always use MAX_ITER)
+//--progressive skips the benchmarks and opens a window on the full view straight away, refining
+//it pass by pass, strict turns solid guessing off
+//--autotune sweeps the block-cyclic tile shape and thread count and saves the best to
+//TUNE_FILE, which later runs on the same host pick up by themselves
+int main( int argc, char **argv ) {
+    Isa isa = detect_isa();
+    Viewport view;
+    bool auto_precision = true;
+    Precision prec = PREC_FLOAT;
+    int max_iter = MAX_ITER;
+    bool progressive = false, progressive_strict = false;
+    bool autotune = false;
+    for (int i=1; i<argc; i++) {
+        if (strncmp(argv[i], "--isa=", 6) == 0) {
+            if (!parse_isa(argv[i] + 6, &isa)) {
+                cerr << "Unknown isa: " << argv[i] + 6 << endl;
+                return 1;
+            }
+            if (!isa_supported(isa)) {
+                cerr << "This cpu can not run the " << isa_names[isa] << " kernel" << endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--cx=", 5) == 0 || strncmp(argv[i], "--cy=", 5) == 0) {
+            const char *end;
+            dd_real c = dd_from_string(argv[i] + 5, &end);
+            if (end == argv[i] + 5 || *end != '\0' || !std::isfinite(to_double(c))) {
+                cerr << "Invalid centre: " << argv[i] << endl;
+                return 1;
+            }
+            if (argv[i][3] == 'x') {
+                view.cx = c;
+                view.cx_text = argv[i] + 5;
+            } else {
+                view.cy = c;
+                view.cy_text = argv[i] + 5;
+            }
+        } else if (strncmp(argv[i], "--zoom=", 7) == 0) {
+            char *end;
+            double zoom = strtod(argv[i] + 7, &end);
+            if (end == argv[i] + 7 || *end != '\0' || !std::isfinite(zoom) || zoom <= 0.0) {
+                cerr << "Invalid zoom: " << argv[i] + 7 << endl;
+                return 1;
+            }
+            view.half_width = JULIA_SCALE / zoom;
+        } else if (strncmp(argv[i], "--precision=", 12) == 0) {
+            auto_precision = strcmp(argv[i] + 12, "auto") == 0;
+            if (!auto_precision && !parse_precision(argv[i] + 12, &prec)) {
+                cerr << "Unknown precision: " << argv[i] + 12 << endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--iters=", 8) == 0) {
+            char *end;
+            long iters = strtol(argv[i] + 8, &end, 10);
+            if (end == argv[i] + 8 || *end != '\0' || iters <= 0 || iters > INT_MAX) {
+                cerr << "Invalid iteration count: " << argv[i] + 8 << endl;
+                return 1;
+            }
+            max_iter = (int)iters;
+        } else if (strcmp(argv[i], "--progressive") == 0 || strcmp(argv[i], "--progressive=strict") == 0) {
+            progressive = true;
+            progressive_strict = argv[i][13] == '=';
+        } else if (strcmp(argv[i], "--autotune") == 0) {
+            autotune = true;
+        } else {
+            cerr << "Unknown option: " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    #ifdef DISPLAY
+    if (progressive)
+        progressive_display_and_exit( progressive_strict );
+    #endif
+
+    if (auto_precision)
+        prec = choose_precision(view);
+    if (precision_bits_needed(view) > precision_bits[prec])
+        cerr << "Warning: " << precision_names[prec] << " can not resolve this zoom, expect pixelation" << endl;
 
-int main( void ) {
     CPUBitmap bitmap( DIM, DIM );
+
+    //block-cyclic tile shape and threads: tuned now, or from an earlier tuning on this host
+    TuneConfig tune;
+    const char *tune_source = "default";
+    if (autotune) {
+        unsigned char *scratch = bitmap.get_ptr();
+        tune = autotune_blockcyclic( [scratch](int w, int h, int threads) { kernel_omp_blockcyclic( scratch, w, h, threads ); } );
+        tune_source = "tuned";
+        if (!save_tune_config( TUNE_FILE, tune ))
+            cerr << "Could not write " << TUNE_FILE << endl;
+    } else if (load_tune_config( TUNE_FILE, tune )) {
+        tune_source = TUNE_FILE;
+    }
     unsigned char *ptr_s = bitmap.get_ptr();
     unsigned char *ptr_p_col = bitmap.get_ptr(); 
     unsigned char *ptr_p_row = bitmap.get_ptr(); 
     unsigned char *ptr_p_2dRow = bitmap.get_ptr();
     unsigned char *ptr_p_2dcol = bitmap.get_ptr();
     unsigned char *ptr_p_omp = bitmap.get_ptr();
-    double start, finish_s, finish_p_row,finish_p_col, finish_p_2dcol,finish_p_2dRow,finish_p_omp; 
+    unsigned char *ptr_p_simd = bitmap.get_ptr();
+    unsigned char *ptr_p_prec = bitmap.get_ptr();
+    unsigned char *ptr_p_perturb = bitmap.get_ptr();
+    unsigned char *ptr_p_bla = bitmap.get_ptr();
+    unsigned char *ref = new unsigned char[bitmap.image_size()]; //copy of the serial image to check against
+    unsigned char *ref_view = new unsigned char[bitmap.image_size()]; //copy of the precision kernel's image of the viewport
+    float *dist = new float[DIM*DIM]; //distance estimate of every pixel of bitmap, 0 where it never escaped
+    half *smooth = new half[DIM*DIM]; //smooth iteration count of every pixel of bitmap, 1.0 where it never escaped
+    uint16_t *iters = new uint16_t[DIM*DIM]; //iteration count of every pixel of bitmap, ITER_INSIDE where it never escaped
+    double finish_p_bc, finish_p_dyn;
+    double start, finish_s, finish_p_row,finish_p_col, finish_p_2dcol,finish_p_2dRow,finish_p_omp,finish_p_simd,finish_p_prec,finish_p_perturb,finish_p_bla; 
 
     start = omp_get_wtime();
     kernel_serial( ptr_s );
 	finish_s = omp_get_wtime() - start;
+    memcpy(ref, ptr_s, bitmap.image_size());
     
 
    start = omp_get_wtime();
@@ -255,6 +648,7 @@ int main( void ) {
     start = omp_get_wtime();
     kernal_omp_colwise( ptr_p_col );
 	finish_p_col = omp_get_wtime() - start;
+    int mismatches_col = count_mismatches(ptr_p_col, ref);
     
     start = omp_get_wtime();
     kernal_omp_rowblock( ptr_p_2dRow );
@@ -263,23 +657,330 @@ int main( void ) {
     start = omp_get_wtime();
     kernal_omp_colblock( ptr_p_2dcol );
 	finish_p_2dcol = omp_get_wtime() - start;
+    int mismatches_2dcol = count_mismatches(ptr_p_2dcol, ref);
+
+    double finish_p_coltiled;
+    start = omp_get_wtime();
+    kernel_omp_colblock_tiled( ptr_p_2dcol );
+    finish_p_coltiled = omp_get_wtime() - start;
+    int mismatches_coltiled = count_mismatches(ptr_p_2dcol, ref);
 
     start = omp_get_wtime();
     kernal_omp_for( ptr_p_omp );
     finish_p_omp = omp_get_wtime() - start;
 
+    start = omp_get_wtime();
+    kernel_omp_blockcyclic( ptr_p_omp, tune.tile_w, tune.tile_h, tune.threads );
+    finish_p_bc = omp_get_wtime() - start;
+    int mismatches_bc = count_mismatches(ptr_p_omp, ref);
+
+    start = omp_get_wtime();
+    kernel_omp_dynamic( ptr_p_omp );
+    finish_p_dyn = omp_get_wtime() - start;
+    int mismatches_dyn = count_mismatches(ptr_p_omp, ref);
+
+    start = omp_get_wtime();
+    kernel_omp_simd( ptr_p_simd, isa );
+    finish_p_simd = omp_get_wtime() - start;
+    int mismatches_simd = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_ws;
+    WorkStealStats ws_stats;
+    start = omp_get_wtime();
+    kernel_omp_worksteal( ptr_p_simd, ws_stats );
+    finish_p_ws = omp_get_wtime() - start;
+    int mismatches_ws = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_cp;
+    std::vector<double> cp_predicted, cp_actual;
+    start = omp_get_wtime();
+    kernel_omp_costpartition( ptr_p_simd, cp_predicted, cp_actual );
+    finish_p_cp = omp_get_wtime() - start;
+    int mismatches_cp = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_ms;
+    start = omp_get_wtime();
+    long long calls_ms = kernel_omp_mariani_silver( ptr_p_simd );
+    finish_p_ms = omp_get_wtime() - start;
+    int mismatches_ms = count_mismatches(ptr_p_simd, ref);
+
+    double finish_bt, finish_p_bt;
+    start = omp_get_wtime();
+    long long calls_bt = kernel_boundary_trace( ptr_p_simd, false );
+    finish_bt = omp_get_wtime() - start;
+    int mismatches_bt = count_mismatches(ptr_p_simd, ref);
+    start = omp_get_wtime();
+    long long calls_p_bt = kernel_boundary_trace( ptr_p_simd, true );
+    finish_p_bt = omp_get_wtime() - start;
+    int mismatches_p_bt = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_prog, finish_p_prog_first, finish_p_strict, finish_p_strict_first;
+    ProgressiveRender prog, prog_strict;
+    start = omp_get_wtime();
+    kernel_omp_progressive( ptr_p_simd, false, prog, &finish_p_prog_first );
+    finish_p_prog = omp_get_wtime() - start;
+    int mismatches_prog = count_mismatches(ptr_p_simd, ref);
+    start = omp_get_wtime();
+    kernel_omp_progressive( ptr_p_simd, true, prog_strict, &finish_p_strict_first );
+    finish_p_strict = omp_get_wtime() - start;
+    int mismatches_strict = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_ia;
+    int ia_resolved;
+    start = omp_get_wtime();
+    kernel_omp_interval( ptr_p_simd, &ia_resolved );
+    finish_p_ia = omp_get_wtime() - start;
+    int mismatches_ia = count_mismatches(ptr_p_simd, ref);
+
+    double finish_p_de;
+    start = omp_get_wtime();
+    DistanceStats de_stats;
+    kernel_omp_distance( ptr_p_simd, dist, de_stats );
+    finish_p_de = omp_get_wtime() - start;
+    int mismatches_de = 0; //the single sample pass has to agree with julia()
+    for (int offset=0; offset<DIM*DIM; offset++)
+        mismatches_de += (dist[offset] == 0.0f) != (ref[offset*4] == 255);
+
+    double finish_p_aa;
+    start = omp_get_wtime();
+    long long aa_resampled = kernel_omp_antialias( ptr_p_simd );
+    finish_p_aa = omp_get_wtime() - start;
+
+    double finish_p_smooth, finish_p_smooth_rgba;
+    start = omp_get_wtime();
+    kernel_omp_smooth( smooth );
+    finish_p_smooth = omp_get_wtime() - start;
+    start = omp_get_wtime();
+    smooth_to_rgba( ptr_p_simd, smooth );
+    finish_p_smooth_rgba = omp_get_wtime() - start;
+    int mismatches_smooth = 0; //never escaped has to be exactly 1.0, escaped below it
+    for (int offset=0; offset<DIM*DIM; offset++)
+        mismatches_smooth += (half_to_float(smooth[offset]) == 1.0f) != (ref[offset*4] == 255);
+
+    //book.h float_to_color() on the smooth counts. The vector kernel is timed against the
+    //scalar loop and the colour pass then runs on the faster one, without -O the
+    //intrinsics can be slower
+    double finish_p_hsl_scalar, finish_p_hsl, finish_p_hsl_chosen;
+    Isa hsl_vector = hsl_kernel_isa( isa );
+    float *field = new float[DIM*DIM];
+    for (int offset=0; offset<DIM*DIM; offset++)
+        field[offset] = half_to_float(smooth[offset]);
+    omp_set_num_threads(NUM_THREADS);
+    hsl_pass( ISA_SCALAR, field, ptr_p_simd ); //warm up, the first pass pays for the threads
+    start = omp_get_wtime();
+    hsl_pass( ISA_SCALAR, field, ptr_p_simd );
+    finish_p_hsl_scalar = omp_get_wtime() - start;
+    unsigned char *ref_hsl = new unsigned char[bitmap.image_size()];
+    memcpy(ref_hsl, ptr_p_simd, bitmap.image_size());
+    finish_p_hsl = finish_p_hsl_scalar;
+    if (hsl_vector != ISA_SCALAR) {
+        start = omp_get_wtime();
+        hsl_pass( hsl_vector, field, ptr_p_simd );
+        finish_p_hsl = omp_get_wtime() - start;
+    }
+    int mismatches_hsl = count_mismatches(ptr_p_simd, ref_hsl);
+    Isa hsl_isa = finish_p_hsl < finish_p_hsl_scalar ? hsl_vector : ISA_SCALAR;
+    start = omp_get_wtime();
+    hsl_pass( hsl_isa, field, ptr_p_simd );
+    finish_p_hsl_chosen = omp_get_wtime() - start;
+    mismatches_hsl += count_mismatches(ptr_p_simd, ref_hsl);
+    delete [] ref_hsl;
+    delete [] field;
+
+    double finish_p_iters, finish_p_colour, finish_p_recolour;
+    Palette binary, gradient;
+    palette_binary( binary );
+    palette_gradient( gradient );
+    start = omp_get_wtime();
+    kernel_omp_iterations( iters );
+    finish_p_iters = omp_get_wtime() - start;
+    start = omp_get_wtime();
+    colour_pass( isa, iters, binary, ptr_p_simd );
+    finish_p_colour = omp_get_wtime() - start;
+    int mismatches_colour = count_mismatches(ptr_p_simd, ref);
+    start = omp_get_wtime();
+    colour_pass( isa, iters, gradient, ptr_p_simd );
+    finish_p_recolour = omp_get_wtime() - start;
+
+    double finish_p_equalise, finish_p_equalise_colour;
+    Palette equalised;
+    omp_set_num_threads(NUM_THREADS);
+    start = omp_get_wtime();
+    palette_equalised( iters, equalised );
+    finish_p_equalise = omp_get_wtime() - start;
+    start = omp_get_wtime();
+    colour_pass( isa, iters, equalised, ptr_p_simd );
+    finish_p_equalise_colour = omp_get_wtime() - start;
+
+    double finish_p_noperiod, finish_p_period;
+    start = omp_get_wtime();
+    long long iters_noperiod = kernel_omp_periodic( ptr_p_simd, max_iter, false );
+    finish_p_noperiod = omp_get_wtime() - start;
+    unsigned char *ref_iters = new unsigned char[bitmap.image_size()]; //image at the requested iteration cap
+    memcpy(ref_iters, ptr_p_simd, bitmap.image_size());
+
+    start = omp_get_wtime();
+    long long iters_period = kernel_omp_periodic( ptr_p_simd, max_iter, true );
+    finish_p_period = omp_get_wtime() - start;
+    int mismatches_period = count_mismatches(ptr_p_simd, ref_iters);
+
+    double finish_cycle, finish_p_cycle;
+    start = omp_get_wtime();
+    AttractingCycle cyc = find_attracting_cycle( JULIA_CR, JULIA_CI );
+    finish_cycle = omp_get_wtime() - start;
+    start = omp_get_wtime();
+    long long iters_cycle = kernel_omp_attractor( ptr_p_simd, max_iter, cyc );
+    finish_p_cycle = omp_get_wtime() - start;
+    int mismatches_cycle = count_mismatches(ptr_p_simd, ref_iters);
+    delete [] ref_iters;
+
+    //the viewport kernels go last so that the displayed image is the requested viewport
+    start = omp_get_wtime();
+    kernel_omp_precision( ptr_p_prec, view, prec );
+    finish_p_prec = omp_get_wtime() - start;
+    memcpy(ref_view, ptr_p_prec, bitmap.image_size());
+
+    double finish_p_sym;
+    start = omp_get_wtime();
+    bool used_symmetry = kernel_omp_symmetric( ptr_p_prec, view, prec );
+    finish_p_sym = omp_get_wtime() - start;
+    int mismatches_sym = count_mismatches(ptr_p_prec, ref_view);
+
+    start = omp_get_wtime();
+    PerturbStats perturb_stats;
+    kernel_omp_perturb( ptr_p_perturb, view, false, perturb_stats );
+    finish_p_perturb = omp_get_wtime() - start;
+    int mismatches_perturb = count_mismatches(ptr_p_perturb, ref_view);
+
+    start = omp_get_wtime();
+    PerturbStats bla_stats;
+    kernel_omp_perturb( ptr_p_bla, view, true, bla_stats );
+    finish_p_bla = omp_get_wtime() - start;
+
     cout << "Elapsed time: " << endl;
     cout << "Serial time: " << finish_s << endl;
     cout << "Parallel time row-wise: " << finish_p_row << endl;
     cout << "Speedup row wise: " << finish_s/finish_p_row << endl;
     cout << "Parallel time col-wise: " << finish_p_col << endl;
     cout << "Speedup col wise: " << finish_s/finish_p_col << endl;
+    cout << "Col-wise pixels different from serial: " << mismatches_col << endl;
     cout << "Parallel time 2drow-wise: " << finish_p_2dRow << endl;
     cout << "Speedup 2drow-wise: " << finish_s/finish_p_2dRow << endl;
     cout << "Parallel time 2dcol-wise: " << finish_p_2dcol << endl;
     cout << "Speedup 2dcol-wise: " << finish_s/finish_p_2dcol << endl;     
+    cout << "2dcol-wise pixels different from serial: " << mismatches_2dcol << endl;
+    cout << "Parallel time 2dcol-wise transposed tiles: " << finish_p_coltiled << endl;
+    cout << "Speedup 2dcol-wise transposed tiles: " << finish_s/finish_p_coltiled << endl;
+    cout << "2dcol-wise transposed tiles pixels different from serial: " << mismatches_coltiled << endl;
     cout << "Parallel time omp for: " << finish_p_omp << endl;
     cout << "Speedup omp for: " << finish_s/finish_p_omp << endl; 
+    cout << "Parallel time block-cyclic " << tune.tile_w << "x" << tune.tile_h << " on " << tune.threads
+         << " threads (" << tune_source << "): " << finish_p_bc << endl;
+    cout << "Speedup block-cyclic: " << finish_s/finish_p_bc << endl;
+    cout << "Block-cyclic pixels different from serial: " << mismatches_bc << endl;
+    cout << "Parallel time dynamic rows: " << finish_p_dyn << endl;
+    cout << "Speedup dynamic rows: " << finish_s/finish_p_dyn << endl;
+    cout << "Dynamic rows pixels different from serial: " << mismatches_dyn << endl;
+    cout << "Parallel time simd (" << isa_names[isa] << "): " << finish_p_simd << endl;
+    cout << "Speedup simd: " << finish_s/finish_p_simd << endl;
+    cout << "Simd pixels different from serial: " << mismatches_simd << endl;
+    cout << "Parallel time work stealing: " << finish_p_ws << endl;
+    cout << "Speedup work stealing: " << finish_s/finish_p_ws << endl;
+    for (int t=0; t<(int)ws_stats.busy.size(); t++)
+        cout << "Work stealing thread " << t << ": busy " << ws_stats.busy[t] << ", idle " << ws_stats.idle[t]
+             << ", tiles " << ws_stats.tiles[t] << " (" << ws_stats.stolen[t] << " stolen)" << endl;
+    cout << "Work stealing pixels different from serial: " << mismatches_ws << endl;
+    cout << "Parallel time cost partition: " << finish_p_cp << endl;
+    cout << "Speedup cost partition: " << finish_s/finish_p_cp << endl;
+    for (int t=0; t<(int)cp_actual.size(); t++)
+        cout << "Cost partition thread " << t << ": predicted " << cp_predicted[t] << ", actual " << cp_actual[t] << endl;
+    cout << "Cost partition pixels different from serial: " << mismatches_cp << endl;
+    cout << "Parallel time mariani-silver: " << finish_p_ms << endl;
+    cout << "Speedup mariani-silver: " << finish_s/finish_p_ms << endl;
+    cout << "Mariani-silver julia calls: " << calls_ms << " of " << DIM*DIM << endl;
+    cout << "Mariani-silver pixels different from serial: " << mismatches_ms << endl;
+    cout << "Serial time boundary trace: " << finish_bt << endl;
+    cout << "Speedup boundary trace: " << finish_s/finish_bt << endl;
+    cout << "Boundary trace julia calls: " << calls_bt << " of " << DIM*DIM << endl;
+    cout << "Boundary trace pixels different from serial: " << mismatches_bt << endl;
+    cout << "Parallel time tiled boundary trace: " << finish_p_bt << endl;
+    cout << "Speedup tiled boundary trace: " << finish_s/finish_p_bt << endl;
+    cout << "Tiled boundary trace julia calls: " << calls_p_bt << " of " << DIM*DIM << endl;
+    cout << "Tiled boundary trace pixels different from serial: " << mismatches_p_bt << endl;
+    cout << "Parallel time progressive: " << finish_p_prog << " (first image after " << finish_p_prog_first << ")" << endl;
+    cout << "Speedup progressive: " << finish_s/finish_p_prog << endl;
+    cout << "Progressive pixels computed/guessed: " << prog.computed << " / " << prog.guessed << endl;
+    cout << "Progressive pixels different from serial: " << mismatches_prog << endl;
+    cout << "Parallel time progressive strict: " << finish_p_strict << " (first image after " << finish_p_strict_first << ")" << endl;
+    cout << "Progressive strict pixels different from serial: " << mismatches_strict << endl;
+    cout << "Parallel time interval tiles: " << finish_p_ia << endl;
+    cout << "Speedup interval tiles: " << finish_s/finish_p_ia << endl;
+    cout << "Interval tiles resolved without per pixel work: " << ia_resolved << " of "
+         << ((DIM + IA_TILE - 1) / IA_TILE) * ((DIM + IA_TILE - 1) / IA_TILE) << endl;
+    cout << "Interval pixels different from serial: " << mismatches_ia << endl;
+    cout << "Parallel time distance estimate aa: " << finish_p_de << endl;
+    cout << "Speedup distance estimate aa: " << finish_s/finish_p_de << endl;
+    cout << "Distance estimate pixels supersampled: " << de_stats.supersampled << " of " << DIM*DIM
+         << " (" << de_stats.refined << " needed the full " << DE_SAMPLES << "x" << DE_SAMPLES << " grid, escape counts up to "
+         << de_stats.cutoff << ")" << endl;
+    cout << "Distance estimate aa cost over one sample: " << (double)(de_stats.base_iterations + de_stats.extra_iterations)/de_stats.base_iterations
+         << "x iterations, " << (de_stats.base_seconds + de_stats.sample_seconds)/de_stats.base_seconds << "x time" << endl;
+    cout << "Distance estimate pixels different from serial: " << mismatches_de << endl;
+    cout << "Parallel time edge aa: " << finish_p_aa << endl;
+    cout << "Speedup edge aa: " << finish_s/finish_p_aa << endl;
+    cout << "Edge aa pixels resampled: " << aa_resampled << " of " << DIM*DIM
+         << " (" << 100.0 * aa_resampled / (DIM*DIM) << "%, " << AA_SAMPLES << "x" << AA_SAMPLES << " jittered)" << endl;
+    cout << "Parallel time smooth count: " << finish_p_smooth << " (+ " << finish_p_smooth_rgba << " to rgba)" << endl;
+    cout << "Speedup smooth count: " << finish_s/finish_p_smooth << endl;
+    cout << "Smooth count buffer: " << DIM*DIM*sizeof(half) << " bytes" << endl;
+    cout << "Smooth count pixels different from serial: " << mismatches_smooth << endl;
+    cout << "Parallel time hsl colour, scalar: " << finish_p_hsl_scalar << endl;
+    cout << "Parallel time hsl colour (" << isa_names[hsl_vector] << "): " << finish_p_hsl << endl;
+    cout << "Speedup hsl colour over scalar: " << finish_p_hsl_scalar/finish_p_hsl << endl;
+    cout << "Parallel time hsl colour pass on the faster path (" << isa_names[hsl_isa] << "): " << finish_p_hsl_chosen << endl;
+    cout << "Hsl colour pixels different from scalar: " << mismatches_hsl << endl;
+    cout << "Parallel time iteration counts: " << finish_p_iters << endl;
+    cout << "Parallel time colour pass (" << isa_names[isa] << "): " << finish_p_colour << endl;
+    cout << "Speedup counts + colour: " << finish_s/(finish_p_iters + finish_p_colour) << endl;
+    cout << "Parallel time recolour with gradient palette: " << finish_p_recolour << endl;
+    cout << "Colour pass pixels different from serial: " << mismatches_colour << endl;
+    cout << "Parallel time histogram + scan: " << finish_p_equalise << " (+ " << finish_p_equalise_colour << " colour pass)" << endl;
+    cout << "Parallel time " << max_iter << " iterations, periodicity off: " << finish_p_noperiod << endl;
+    cout << "Parallel time " << max_iter << " iterations, periodicity on: " << finish_p_period << endl;
+    cout << "Speedup periodicity: " << finish_p_noperiod/finish_p_period << endl;
+    cout << "Iterations run without/with periodicity: " << iters_noperiod << " / " << iters_period << endl;
+    cout << "Periodicity pixels different from exhaustive: " << mismatches_period << endl;
+    if (cyc.found)
+        cout << "Attracting cycle: period " << cyc.period << ", multiplier " << cyc.multiplier
+             << ", radius " << cyc.radius << " (found in " << finish_cycle << ")" << endl;
+    else
+        cout << "Attracting cycle: none, attractor kernel runs the plain loop (searched in " << finish_cycle << ")" << endl;
+    cout << "Parallel time " << max_iter << " iterations, attracting cycle: " << finish_p_cycle << endl;
+    cout << "Speedup attracting cycle: " << finish_p_noperiod/(finish_cycle + finish_p_cycle) << endl;
+    cout << "Iterations run with attracting cycle: " << iters_cycle << endl;
+    cout << "Attracting cycle pixels different from exhaustive: " << mismatches_cycle << endl;
+    cout << "Parallel time precision (" << precision_names[prec] << "): " << finish_p_prec << endl;
+    cout << "Speedup precision: " << finish_s/finish_p_prec << endl;
+    if (view.is_default())
+        cout << "Precision pixels different from serial: " << count_mismatches(ref_view, ref) << endl;
+    cout << "Parallel time symmetric (" << (used_symmetry ? "half computed" : "off-centre, full render") << "): " << finish_p_sym << endl;
+    cout << "Speedup symmetric over precision: " << finish_p_prec/finish_p_sym << endl;
+    cout << "Symmetric pixels different from precision: " << mismatches_sym << endl;
+    cout << "Parallel time perturbation (" << perturb_stats.reference_bits << " bit reference): " << finish_p_perturb << endl;
+    cout << "Speedup perturbation over precision: " << finish_p_prec/finish_p_perturb << endl;
+    cout << "Perturbation glitched pixels: " << perturb_stats.glitched << " fixed with " << perturb_stats.references
+         << " extra references in " << perturb_stats.rounds << " rounds (" << perturb_stats.direct << " computed directly)" << endl;
+    cout << "Perturbation pixels different from precision: " << mismatches_perturb << endl;
+    cout << "Parallel time perturbation + bla: " << finish_p_bla << endl;
+    cout << "Speedup bla over perturbation: " << finish_p_perturb/finish_p_bla << endl;
+    cout << "Bla iterations skipped: " << bla_stats.bla_skipped << endl;
+    cout << "Bla pixels different from precision: " << count_mismatches(ptr_p_bla, ref_view) << endl;
+
+    delete [] ref;
+    delete [] ref_view;
+    delete [] dist;
+    delete [] smooth;
+    delete [] iters;
 	    
     #ifdef DISPLAY     
     bitmap.display_and_exit();
@@ -0,0 +1,23 @@
+/* File:     fractal.h
+ *
+ * Purpose:  constants shared between fractal.cpp and the kernel headers
+ *           that it pulls in (image size, thread count and the julia set parameters),
+ *           and julia() itself for the other translation units
+ *
+ */
+
+#ifndef __FRACTAL_H__
+#define __FRACTAL_H__
+
+#define DIM 768 //defines the image dimensions width and height
+#define NUM_THREADS 16
+
+#define MAX_ITER 200      //max number of iterations of a = a*a + c per pixel
+#define BAILOUT 1000      //squared magnitude that counts as divergence
+#define JULIA_SCALE 1.5   //half width of the window on the complex plane
+#define JULIA_CR -0.8     //real part of c
+#define JULIA_CI 0.156    //imaginary part of c
+
+int julia( int x, int y );  //defined in fractal.cpp, 1 inside the set and 0 outside
+
+#endif  // __FRACTAL_H__
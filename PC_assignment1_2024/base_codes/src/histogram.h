@@ -0,0 +1,96 @@
+/* File:     histogram.h
+ *
+ * Purpose:  histogram equalised colouring of an iteration count buffer. Plain
+ *           count -> colour palettes spend most of the gradient on counts hardly
+ *           any pixel has, equalising gives each colour about the same share of
+ *           the escaped pixels instead: a count n is placed at
+ *
+ *               cdf(n) / escaped = (pixels that escaped before n) / (all escaped pixels)
+ *
+ *           along the gradient. That turns into an ordinary Palette so the colour
+ *           pass of palette.h does the rest.
+ *
+ *           Every step runs on all threads: each thread counts into its own
+ *           histogram, the histograms are summed bin by bin, and the cdf comes from
+ *           a blocked exclusive scan (each thread scans its block, the block totals
+ *           are scanned, then added back).
+ *
+ */
+
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#include <vector>
+#include <stdint.h>
+#include <omp.h>
+#include "fractal.h"
+#include "palette.h"
+
+//hist gets the number of pixels with each count 0 .. PALETTE_SIZE-1
+inline void build_histogram( const uint16_t *iters, long long *hist ) {
+    int threads = omp_get_max_threads();
+    std::vector<long long> partial((size_t)threads * PALETTE_SIZE, 0); //one histogram per thread
+
+    #pragma omp parallel
+    {
+        long long *mine = &partial[(size_t)omp_get_thread_num() * PALETTE_SIZE];
+        #pragma omp for schedule(static)
+        for (int offset=0; offset<DIM*DIM; offset++)
+            mine[iters[offset]]++;
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int n=0; n<PALETTE_SIZE; n++) {
+        long long sum = 0;
+        for (int t=0; t<threads; t++)
+            sum += partial[(size_t)t * PALETTE_SIZE + n];
+        hist[n] = sum;
+    }
+}
+
+//out[k] = in[0] + .. + in[k-1], returns the total
+inline long long exclusive_scan( const long long *in, long long *out, int n ) {
+    int threads = omp_get_max_threads();
+    std::vector<long long> block_sum(threads + 1, 0);
+    int used = 0; //threads the region actually got
+
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        int begin = (int)((long long)n * t / nt), end = (int)((long long)n * (t + 1) / nt);
+
+        long long sum = 0;
+        for (int k=begin; k<end; k++) {
+            out[k] = sum;
+            sum += in[k];
+        }
+        block_sum[t + 1] = sum;
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            for (int b=1; b<=nt; b++)
+                block_sum[b] += block_sum[b - 1];
+            used = nt;
+        }
+
+        for (int k=begin; k<end; k++)
+            out[k] += block_sum[t];
+    }
+    return block_sum[used];
+}
+
+//palette that equalises the counts in iters over the gradient, inside stays red
+inline void palette_equalised( const uint16_t *iters, Palette &p ) {
+    long long hist[PALETTE_SIZE], cdf[PALETTE_SIZE];
+    build_histogram(iters, hist);
+    exclusive_scan(hist, cdf, PALETTE_SIZE);
+    long long escaped = cdf[ITER_INSIDE]; //every pixel below the inside count
+
+    #pragma omp parallel for schedule(static)
+    for (int n=0; n<ITER_INSIDE; n++)
+        p.lut[n] = gradient_rgba(escaped > 0 ? (float)cdf[n] / escaped : 0.0f);
+    p.lut[ITER_INSIDE] = pack_rgba(255, 0, 0, 255);
+}
+
+#endif  // __HISTOGRAM_H__
@@ -0,0 +1,174 @@
+/* File:     hsl.h
+ *
+ * Purpose:  CPU port of float_to_color() and value() from common/book.h, which
+ *           only build for CUDA. A float field (0 .. 1, e.g. smooth iteration
+ *           counts) is taken as the lightness of a fully saturated HSL colour whose
+ *           hue also follows the field, and written as RGBA into the bitmap.
+ *
+ *           The scalar version is the CUDA code line for line. The vector versions
+ *           do the same float operations in the same order (no FMA, see the
+ *           Makefile) and truncate like the (int) and (unsigned char) casts, so they
+ *           give the same bytes. Their % 360 is done as t - 360 * trunc(t / 360),
+ *           which is exact while |360 * l| < 2^20 - far outside the 0 .. 1 the
+ *           field is meant to hold.
+ *
+ */
+
+#ifndef __HSL_H__
+#define __HSL_H__
+
+#include <stdint.h>
+#include <immintrin.h>
+#include <omp.h>
+#include "fractal.h"
+#include "cpu_dispatch.h"
+
+//value() of book.h
+inline unsigned char hsl_value( float n1, float n2, int hue ) {
+    if (hue > 360)      hue -= 360;
+    else if (hue < 0)   hue += 360;
+
+    if (hue < 60)
+        return (unsigned char)(255 * (n1 + (n2-n1)*hue/60));
+    if (hue < 180)
+        return (unsigned char)(255 * n2);
+    if (hue < 240)
+        return (unsigned char)(255 * (n1 + (n2-n1)*(240-hue)/60));
+    return (unsigned char)(255 * n1);
+}
+
+//float_to_color() of book.h for pixels begin .. end-1
+inline void hsl_scalar( const float *field, unsigned char *optr, int begin, int end ) {
+    for (int offset=begin; offset<end; offset++) {
+        float l = field[offset];
+        float s = 1;
+        int h = (180 + (int)(360.0f * field[offset])) % 360;
+        float m1, m2;
+
+        if (l <= 0.5f)
+            m2 = l * (1 + s);
+        else
+            m2 = l + s - l * s;
+        m1 = 2 * l - m2;
+
+        optr[offset*4 + 0] = hsl_value( m1, m2, h+120 );
+        optr[offset*4 + 1] = hsl_value( m1, m2, h );
+        optr[offset*4 + 2] = hsl_value( m1, m2, h -120 );
+        optr[offset*4 + 3] = 255;
+    }
+}
+
+//hsl_value() for 8 lanes, returns the bytes in the low 8 bits of each lane
+__attribute__((target("avx2")))
+inline __m256i hsl_value_avx2( __m256 n1, __m256 n2, __m256i hue ) {
+    const __m256i v360 = _mm256_set1_epi32(360);
+    __m256i over = _mm256_cmpgt_epi32(hue, v360);
+    __m256i under = _mm256_cmpgt_epi32(_mm256_setzero_si256(), hue);
+    hue = _mm256_sub_epi32(hue, _mm256_and_si256(over, v360));
+    hue = _mm256_add_epi32(hue, _mm256_and_si256(under, v360));
+
+    const __m256 v255 = _mm256_set1_ps(255.0f), v60 = _mm256_set1_ps(60.0f);
+    __m256 d = _mm256_sub_ps(n2, n1);
+    __m256 rise = _mm256_mul_ps(v255, _mm256_add_ps(n1, _mm256_div_ps(_mm256_mul_ps(d, _mm256_cvtepi32_ps(hue)), v60)));
+    __m256 fall = _mm256_mul_ps(v255, _mm256_add_ps(n1, _mm256_div_ps(_mm256_mul_ps(d,
+                      _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_set1_epi32(240), hue))), v60)));
+
+    //pick from the last case backwards so the earliest true test wins
+    __m256 v = _mm256_mul_ps(v255, n1);
+    v = _mm256_blendv_ps(v, fall, _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(240), hue)));
+    v = _mm256_blendv_ps(v, _mm256_mul_ps(v255, n2), _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(180), hue)));
+    v = _mm256_blendv_ps(v, rise, _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(60), hue)));
+    return _mm256_and_si256(_mm256_cvttps_epi32(v), _mm256_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx2")))
+inline void hsl_avx2( const float *field, unsigned char *optr, int begin, int end ) {
+    int k = begin;
+    for (; k + 8 <= end; k += 8) {
+        __m256 l = _mm256_loadu_ps(field + k);
+        const __m256 s = _mm256_set1_ps(1.0f);
+
+        __m256i t = _mm256_add_epi32(_mm256_set1_epi32(180), _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set1_ps(360.0f), l)));
+        __m256i q = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(t), _mm256_set1_ps(360.0f)));
+        __m256i h = _mm256_sub_epi32(t, _mm256_mullo_epi32(q, _mm256_set1_epi32(360)));
+
+        __m256 low = _mm256_mul_ps(l, _mm256_add_ps(s, s));
+        __m256 high = _mm256_sub_ps(_mm256_add_ps(l, s), _mm256_mul_ps(l, s));
+        __m256 m2 = _mm256_blendv_ps(high, low, _mm256_cmp_ps(l, _mm256_set1_ps(0.5f), _CMP_LE_OQ));
+        __m256 m1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), l), m2);
+
+        __m256i r = hsl_value_avx2(m1, m2, _mm256_add_epi32(h, _mm256_set1_epi32(120)));
+        __m256i g = hsl_value_avx2(m1, m2, h);
+        __m256i b = hsl_value_avx2(m1, m2, _mm256_sub_epi32(h, _mm256_set1_epi32(120)));
+        __m256i rgba = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                       _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32(0xFF000000)));
+        _mm256_storeu_si256((__m256i *)(optr + k*4), rgba);
+    }
+    hsl_scalar(field, optr, k, end);
+}
+
+//hsl_value() for 16 lanes
+__attribute__((target("avx512f")))
+inline __m512i hsl_value_avx512( __m512 n1, __m512 n2, __m512i hue ) {
+    const __m512i v360 = _mm512_set1_epi32(360);
+    hue = _mm512_mask_sub_epi32(hue, _mm512_cmpgt_epi32_mask(hue, v360), hue, v360);
+    hue = _mm512_mask_add_epi32(hue, _mm512_cmplt_epi32_mask(hue, _mm512_setzero_si512()), hue, v360);
+
+    const __m512 v255 = _mm512_set1_ps(255.0f), v60 = _mm512_set1_ps(60.0f);
+    __m512 d = _mm512_sub_ps(n2, n1);
+    __m512 rise = _mm512_mul_ps(v255, _mm512_add_ps(n1, _mm512_div_ps(_mm512_mul_ps(d, _mm512_cvtepi32_ps(hue)), v60)));
+    __m512 fall = _mm512_mul_ps(v255, _mm512_add_ps(n1, _mm512_div_ps(_mm512_mul_ps(d,
+                      _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_set1_epi32(240), hue))), v60)));
+
+    __m512 v = _mm512_mul_ps(v255, n1);
+    v = _mm512_mask_mov_ps(v, _mm512_cmplt_epi32_mask(hue, _mm512_set1_epi32(240)), fall);
+    v = _mm512_mask_mov_ps(v, _mm512_cmplt_epi32_mask(hue, _mm512_set1_epi32(180)), _mm512_mul_ps(v255, n2));
+    v = _mm512_mask_mov_ps(v, _mm512_cmplt_epi32_mask(hue, _mm512_set1_epi32(60)), rise);
+    return _mm512_and_si512(_mm512_cvttps_epi32(v), _mm512_set1_epi32(0xFF));
+}
+
+__attribute__((target("avx512f")))
+inline void hsl_avx512( const float *field, unsigned char *optr, int begin, int end ) {
+    int k = begin;
+    for (; k + 16 <= end; k += 16) {
+        __m512 l = _mm512_loadu_ps(field + k);
+        const __m512 s = _mm512_set1_ps(1.0f);
+
+        __m512i t = _mm512_add_epi32(_mm512_set1_epi32(180), _mm512_cvttps_epi32(_mm512_mul_ps(_mm512_set1_ps(360.0f), l)));
+        __m512i q = _mm512_cvttps_epi32(_mm512_div_ps(_mm512_cvtepi32_ps(t), _mm512_set1_ps(360.0f)));
+        __m512i h = _mm512_sub_epi32(t, _mm512_mullo_epi32(q, _mm512_set1_epi32(360)));
+
+        __m512 low = _mm512_mul_ps(l, _mm512_add_ps(s, s));
+        __m512 high = _mm512_sub_ps(_mm512_add_ps(l, s), _mm512_mul_ps(l, s));
+        __m512 m2 = _mm512_mask_mov_ps(high, _mm512_cmp_ps_mask(l, _mm512_set1_ps(0.5f), _CMP_LE_OQ), low);
+        __m512 m1 = _mm512_sub_ps(_mm512_mul_ps(_mm512_set1_ps(2.0f), l), m2);
+
+        __m512i r = hsl_value_avx512(m1, m2, _mm512_add_epi32(h, _mm512_set1_epi32(120)));
+        __m512i g = hsl_value_avx512(m1, m2, h);
+        __m512i b = hsl_value_avx512(m1, m2, _mm512_sub_epi32(h, _mm512_set1_epi32(120)));
+        __m512i rgba = _mm512_or_si512(_mm512_or_si512(r, _mm512_slli_epi32(g, 8)),
+                                       _mm512_or_si512(_mm512_slli_epi32(b, 16), _mm512_set1_epi32(0xFF000000)));
+        _mm512_storeu_si512(optr + k*4, rgba);
+    }
+    hsl_scalar(field, optr, k, end);
+}
+
+//the level whose code hsl_pass( isa, ... ) really runs, sse2 has no vector version
+inline Isa hsl_kernel_isa( Isa isa ) {
+    return isa == ISA_AVX512 || isa == ISA_AVX2 ? isa : ISA_SCALAR;
+}
+
+//float_to_color() over the whole image on all threads, isa picks the vector width
+//(sse2 has no vector version and takes the scalar loop)
+inline void hsl_pass( Isa isa, const float *field, unsigned char *ptr ) {
+    #pragma omp parallel for schedule(static)
+    for (int y=0; y<DIM; y++) {
+        switch (isa) {
+            case ISA_AVX512: hsl_avx512( field, ptr, y * DIM, (y + 1) * DIM ); break;
+            case ISA_AVX2:   hsl_avx2( field, ptr, y * DIM, (y + 1) * DIM ); break;
+            default:         hsl_scalar( field, ptr, y * DIM, (y + 1) * DIM ); break;
+        }
+    }
+}
+
+#endif  // __HSL_H__
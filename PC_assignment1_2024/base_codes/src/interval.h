@@ -0,0 +1,114 @@
+/* File:     interval.h
+ *
+ * Purpose:  interval arithmetic pre-pass that proves the value of whole tiles.
+ *           A tile covers a rectangle of the complex plane. Iterating that
+ *           rectangle as an interval box z = z^2 + c gives a box that contains the
+ *           orbits of all of its pixels.
+ *
+ *             - if at some step the smallest |z|^2 in the box is > BAILOUT, every
+ *               pixel has escaped by then and the whole tile is 0
+ *             - if after MAX_ITER steps the largest |z|^2 never went over BAILOUT,
+ *               no pixel escapes and the whole tile is 1
+ *
+ *           julia() iterates in float, so every interval result is widened by a
+ *           few float ulps (IA_WIDEN) to cover the float rounding as well. A
+ *           verdict is then about what julia() itself returns, not just about the
+ *           exact iteration.
+ *
+ */
+
+#ifndef __INTERVAL_H__
+#define __INTERVAL_H__
+
+#include <algorithm>
+#include <cmath>
+#include "fractal.h"
+#include "viewport.h"
+
+#define IA_TILE 16                  //tile width and height in pixels
+#define IA_WIDEN (1.0 / (1 << 21))  //relative widening per operation, 8 float ulps
+
+//per tile result of the pre-pass
+enum TileVerdict { TILE_UNKNOWN = 0, TILE_ESCAPES, TILE_BOUNDED };
+
+struct Interval {
+    double  lo, hi;
+    Interval( void ) : lo(0.0), hi(0.0) {}
+    Interval( double l, double h ) : lo(l), hi(h) {}
+};
+
+//widens outwards by IA_WIDEN relative to the magnitude
+inline Interval ia_widen( const Interval &a ) {
+    double m = std::max(fabs(a.lo), fabs(a.hi)) * IA_WIDEN;
+    return Interval(a.lo - m, a.hi + m);
+}
+
+inline Interval operator+( const Interval &a, const Interval &b ) {
+    return ia_widen(Interval(a.lo + b.lo, a.hi + b.hi));
+}
+
+inline Interval operator-( const Interval &a, const Interval &b ) {
+    return ia_widen(Interval(a.lo - b.hi, a.hi - b.lo));
+}
+
+inline Interval operator*( const Interval &a, const Interval &b ) {
+    double p1 = a.lo * b.lo, p2 = a.lo * b.hi, p3 = a.hi * b.lo, p4 = a.hi * b.hi;
+    return ia_widen(Interval(std::min(std::min(p1, p2), std::min(p3, p4)),
+                             std::max(std::max(p1, p2), std::max(p3, p4))));
+}
+
+//a*a is tighter than a*a through operator* because both factors are the same number
+inline Interval ia_sqr( const Interval &a ) {
+    double l2 = a.lo * a.lo, h2 = a.hi * a.hi;
+    if (a.lo <= 0.0 && a.hi >= 0.0)
+        return ia_widen(Interval(0.0, std::max(l2, h2)));
+    return ia_widen(Interval(std::min(l2, h2), std::max(l2, h2)));
+}
+
+//proves the value of the tile of pixels [x0, x1) x [y0, y1) of the full view if it can
+inline TileVerdict classify_tile( int x0, int y0, int x1, int y1 ) {
+    //coordinates decrease with the pixel index, so the last pixel gives the low end
+    //pixel_coord() is julia()'s float jx and jy
+    Interval r(pixel_coord(x1 - 1), pixel_coord(x0));
+    Interval i(pixel_coord(y1 - 1), pixel_coord(y0));
+    //julia() adds c in float, so the proof has to be about the float c too
+    const Interval cr((float)JULIA_CR, (float)JULIA_CR), ci((float)JULIA_CI, (float)JULIA_CI);
+    const Interval two(2.0, 2.0);
+    bool bounded = true;
+
+    for (int n=0; n<MAX_ITER; n++) {
+        //same operations as cuComplex: r*r - i*i + cr, (i*r + r*i) + ci
+        Interval rr = ia_sqr(r), ii = ia_sqr(i);
+        Interval nr = (rr - ii) + cr;
+        Interval ni = two * (r * i) + ci;
+        r = nr;
+        i = ni;
+
+        Interval mag = ia_sqr(r) + ia_sqr(i);
+        if (mag.lo > BAILOUT)
+            return TILE_ESCAPES;
+        if (mag.hi > BAILOUT)
+            bounded = false;
+        if (!bounded && (r.hi - r.lo) > 4.0 * sqrt(BAILOUT))
+            return TILE_UNKNOWN; //box is wider than the escape disc, no proof will come
+    }
+    return bounded ? TILE_BOUNDED : TILE_UNKNOWN;
+}
+
+//pre-pass over all tiles of the full view, verdicts has one entry per tile (row major),
+//returns the number of tiles that got a verdict
+inline int classify_tiles( TileVerdict *verdicts ) {
+    const int tiles_x = (DIM + IA_TILE - 1) / IA_TILE;
+    int resolved = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:resolved)
+    for (int t=0; t<tiles_x*tiles_x; t++) {
+        int x0 = (t % tiles_x) * IA_TILE, y0 = (t / tiles_x) * IA_TILE;
+        int x1 = std::min(x0 + IA_TILE, DIM), y1 = std::min(y0 + IA_TILE, DIM);
+        verdicts[t] = classify_tile(x0, y0, x1, y1);
+        resolved += verdicts[t] != TILE_UNKNOWN;
+    }
+    return resolved;
+}
+
+#endif  // __INTERVAL_H__
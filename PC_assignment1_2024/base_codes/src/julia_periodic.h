@@ -0,0 +1,57 @@
+/* File:     julia_periodic.h
+ *
+ * Purpose:  julia() with a runtime iteration cap and Brent style periodicity
+ *           checking. Interior pixels never escape, so without a check they run
+ *           all max_iter iterations. Their orbits fall into an attracting cycle,
+ *           so we keep one saved z and compare every new z with it. The saved z
+ *           is replaced after 1, 2, 4, 8, ... steps, and that catches a cycle of
+ *           any period once the window is longer than the period.
+ *
+ */
+
+#ifndef __JULIA_PERIODIC_H__
+#define __JULIA_PERIODIC_H__
+
+#include <cmath>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "julia_precision.h"
+
+//distance at which a revisited z counts as the same point
+#define PERIOD_EPSILON 1e-6f
+
+//escape_orbit() watch that stops an orbit once it comes back to the saved z
+struct PeriodWatch {
+    bool    enabled;
+    float   saved_r, saved_i;   //z we compare against
+    int     window, since_saved; //steps until the saved z is replaced, and steps since it was
+
+    PeriodWatch( bool on, const cuComplex &start )
+        : enabled(on), saved_r(start.r), saved_i(start.i), window(1), since_saved(0) {}
+
+    void before_step( const cuComplex & ) {}
+
+    bool captured( const cuComplex &a ) {
+        if (!enabled)
+            return false;
+        if (fabsf(a.r - saved_r) < PERIOD_EPSILON && fabsf(a.i - saved_i) < PERIOD_EPSILON)
+            return true; //orbit is cycling, it will never escape
+        if (++since_saved == window) {
+            saved_r = a.r;
+            saved_i = a.i;
+            since_saved = 0;
+            window *= 2;
+        }
+        return false;
+    }
+};
+
+//same as julia(x, y) for max_iter = MAX_ITER and periodicity off, iterations gets
+//the number of iterations actually run (for measuring what the check saves)
+inline int julia_periodic( int x, int y, int max_iter, bool periodicity, int *iterations ) {
+    cuComplex a(pixel_coord(x), pixel_coord(y));
+    PeriodWatch watch(periodicity, a);
+    return escape_orbit(a, max_iter, watch, *iterations) ? 0 : 1;
+}
+
+#endif  // __JULIA_PERIODIC_H__
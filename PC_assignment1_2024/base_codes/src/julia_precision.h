@@ -0,0 +1,63 @@
+/* File:     julia_precision.h
+ *
+ * Purpose:  the julia() escape loop templated on the scalar type, so any viewport
+ *           can be rendered in float, double, long double or double-double.
+ *
+ *           escape_orbit() is that loop for every julia variant in the tree. What a
+ *           variant needs on top (the distance estimate's derivative, the interior
+ *           exits of the periodicity and attractor kernels) comes in as a watch
+ *           object, like the policies of render_driver.h.
+ *
+ */
+
+#ifndef __JULIA_PRECISION_H__
+#define __JULIA_PRECISION_H__
+
+#include "fractal.h"
+#include "cu_complex.h"
+#include "viewport.h"
+
+//watch of the plain loop: nothing runs before a step and no orbit is stopped early
+struct NoWatch {
+    template <typename C> void before_step( const C & ) {}
+    template <typename C> bool captured( const C & ) { return false; }
+};
+
+//a = a * a + c from the start point a until |a|^2 passes BAILOUT (returns true), max_iter
+//steps are done, or watch.captured(a) says the orbit is trapped (returns false).
+//a ends as the last z and iterations gets the steps run, the escaping one included
+template <typename T, typename Watch>
+inline bool escape_orbit( cuComplexT<T> &a, int max_iter, Watch &watch, int &iterations ) {
+    cuComplexT<T> c(T(JULIA_CR), T(JULIA_CI));
+    const T bailout = T(BAILOUT);
+
+    for (int i=0; i<max_iter; i++) {
+        watch.before_step(a);
+        a = a * a + c;
+        if (a.magnitude2() > bailout) {
+            iterations = i + 1;
+            return true;
+        }
+        if (watch.captured(a)) {
+            iterations = i + 1;
+            return false;
+        }
+    }
+    iterations = max_iter;
+    return false;
+}
+
+//same escape loop as julia() but in the scalar type T and for any viewport
+//julia_t<float>(x, y, Viewport()) gives exactly julia(x, y)
+template <typename T>
+int julia_t( int x, int y, const Viewport &view ) {
+    T jx, jy;
+    view_coord<T>(view, x, y, jx, jy);
+
+    cuComplexT<T> a(jx, jy);
+    NoWatch watch;
+    int iterations;
+    return escape_orbit(a, MAX_ITER, watch, iterations) ? 0 : 1;
+}
+
+#endif  // __JULIA_PRECISION_H__
@@ -0,0 +1,131 @@
+/* File:     julia_simd.h
+ *
+ * Purpose:  SIMD versions of julia() that run a strip of pixels from one row
+ *           in vector lanes, 4 at a time with SSE2, 8 with AVX2 and 16 with AVX-512.
+ *           Each lane does exactly the same float operations as the scalar julia()
+ *           (no FMA, same order) so the results match it bit for bit.
+ *
+ *           The functions are compiled with target attributes so the rest of the
+ *           program stays generic x86-64 - only call them when the cpu has the ISA.
+ *
+ */
+
+#ifndef __JULIA_SIMD_H__
+#define __JULIA_SIMD_H__
+
+#include <immintrin.h>
+#include "fractal.h"
+
+//number of pixels handled by one call of each variant
+#define SSE2_LANES 4
+#define AVX2_LANES 8
+#define AVX512_LANES 16
+
+//computes julia() for the pixels (x0 .. x0+3, y) and writes the 0/1 results to out
+//SSE2 has no blendv so the masking is done with and/andnot/or
+__attribute__((target("sse2")))
+inline void julia_sse2( int x0, int y, int *out ) {
+    const float scale = JULIA_SCALE;
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vhalf = _mm_set1_ps((float)(DIM/2));
+    const __m128 cr = _mm_set1_ps((float)JULIA_CR);
+    const __m128 ci = _mm_set1_ps((float)JULIA_CI);
+    const __m128 bailout = _mm_set1_ps((float)BAILOUT);
+
+    __m128i vx = _mm_sub_epi32(_mm_set1_epi32(DIM/2),
+                               _mm_add_epi32(_mm_set1_epi32(x0), _mm_setr_epi32(0, 1, 2, 3)));
+    __m128 ar = _mm_div_ps(_mm_mul_ps(vscale, _mm_cvtepi32_ps(vx)), vhalf);
+    __m128 ai = _mm_set1_ps(scale * (float)(DIM/2 - y)/(DIM/2));
+
+    __m128 alive = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+    for (int i=0; i<MAX_ITER; i++) {
+        __m128 nr = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(ar, ar), _mm_mul_ps(ai, ai)), cr);
+        __m128 ni = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ai, ar), _mm_mul_ps(ar, ai)), ci);
+        ar = _mm_or_ps(_mm_and_ps(alive, nr), _mm_andnot_ps(alive, ar));
+        ai = _mm_or_ps(_mm_and_ps(alive, ni), _mm_andnot_ps(alive, ai));
+
+        __m128 mag = _mm_add_ps(_mm_mul_ps(ar, ar), _mm_mul_ps(ai, ai));
+        __m128 escaped = _mm_and_ps(alive, _mm_cmpgt_ps(mag, bailout));
+        alive = _mm_andnot_ps(escaped, alive);
+        if (_mm_movemask_ps(alive) == 0)
+            break;
+    }
+
+    __m128i res = _mm_srli_epi32(_mm_castps_si128(alive), 31);
+    _mm_storeu_si128((__m128i *)out, res);
+}
+
+//computes julia() for the pixels (x0 .. x0+7, y) and writes the 0/1 results to out
+__attribute__((target("avx2")))
+inline void julia_avx2( int x0, int y, int *out ) {
+    const float scale = JULIA_SCALE;
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 vhalf = _mm256_set1_ps((float)(DIM/2));
+    const __m256 cr = _mm256_set1_ps((float)JULIA_CR);
+    const __m256 ci = _mm256_set1_ps((float)JULIA_CI);
+    const __m256 bailout = _mm256_set1_ps((float)BAILOUT);
+
+    //DIM/2 - x for every lane, converted exactly like the scalar (float) cast
+    __m256i vx = _mm256_sub_epi32(_mm256_set1_epi32(DIM/2),
+                                  _mm256_add_epi32(_mm256_set1_epi32(x0), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    __m256 ar = _mm256_div_ps(_mm256_mul_ps(vscale, _mm256_cvtepi32_ps(vx)), vhalf);
+    __m256 ai = _mm256_set1_ps(scale * (float)(DIM/2 - y)/(DIM/2));
+
+    //all bits set in a lane while that pixel has not escaped
+    __m256 alive = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    for (int i=0; i<MAX_ITER; i++) {
+        //a = a * a + c, same operation order as cuComplex
+        __m256 nr = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(ar, ar), _mm256_mul_ps(ai, ai)), cr);
+        __m256 ni = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ai, ar), _mm256_mul_ps(ar, ai)), ci);
+        //escaped lanes keep their last value so they never run off to inf/nan
+        ar = _mm256_blendv_ps(ar, nr, alive);
+        ai = _mm256_blendv_ps(ai, ni, alive);
+
+        __m256 mag = _mm256_add_ps(_mm256_mul_ps(ar, ar), _mm256_mul_ps(ai, ai));
+        __m256 escaped = _mm256_and_ps(alive, _mm256_cmp_ps(mag, bailout, _CMP_GT_OQ));
+        alive = _mm256_andnot_ps(escaped, alive);
+        if (_mm256_testz_ps(alive, alive)) //every lane has diverged
+            break;
+    }
+
+    //alive lanes are all ones -> shift down to 0/1
+    __m256i res = _mm256_srli_epi32(_mm256_castps_si256(alive), 31);
+    _mm256_storeu_si256((__m256i *)out, res);
+}
+
+//computes julia() for the pixels (x0 .. x0+15, y) and writes the 0/1 results to out
+__attribute__((target("avx512f")))
+inline void julia_avx512( int x0, int y, int *out ) {
+    const float scale = JULIA_SCALE;
+    const __m512 vscale = _mm512_set1_ps(scale);
+    const __m512 vhalf = _mm512_set1_ps((float)(DIM/2));
+    const __m512 cr = _mm512_set1_ps((float)JULIA_CR);
+    const __m512 ci = _mm512_set1_ps((float)JULIA_CI);
+    const __m512 bailout = _mm512_set1_ps((float)BAILOUT);
+
+    __m512i vx = _mm512_sub_epi32(_mm512_set1_epi32(DIM/2),
+                                  _mm512_add_epi32(_mm512_set1_epi32(x0),
+                                                   _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+    __m512 ar = _mm512_div_ps(_mm512_mul_ps(vscale, _mm512_cvtepi32_ps(vx)), vhalf);
+    __m512 ai = _mm512_set1_ps(scale * (float)(DIM/2 - y)/(DIM/2));
+
+    __mmask16 alive = 0xFFFF;
+
+    for (int i=0; i<MAX_ITER; i++) {
+        __m512 nr = _mm512_add_ps(_mm512_sub_ps(_mm512_mul_ps(ar, ar), _mm512_mul_ps(ai, ai)), cr);
+        __m512 ni = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(ai, ar), _mm512_mul_ps(ar, ai)), ci);
+        ar = _mm512_mask_blend_ps(alive, ar, nr);
+        ai = _mm512_mask_blend_ps(alive, ai, ni);
+
+        __m512 mag = _mm512_add_ps(_mm512_mul_ps(ar, ar), _mm512_mul_ps(ai, ai));
+        alive &= ~_mm512_mask_cmp_ps_mask(alive, mag, bailout, _CMP_GT_OQ);
+        if (alive == 0)
+            break;
+    }
+
+    _mm512_storeu_si512(out, _mm512_maskz_mov_epi32(alive, _mm512_set1_epi32(1)));
+}
+
+#endif  // __JULIA_SIMD_H__
@@ -0,0 +1,127 @@
+/* File:     mariani_silver.h
+ *
+ * Purpose:  Mariani-Silver rectangle subdivision. If every pixel on the border
+ *           of a rectangle has the same value the inside is filled without being
+ *           computed, otherwise the rectangle is cut in two along its longer side
+ *           (computing only the cut line) and both halves are handled the same way
+ *           as OpenMP tasks.
+ *
+ *           A uniform border alone is not enough on a dust like julia set, a small
+ *           island can sit fully inside it. So the fill also needs classify_tile()
+ *           from interval.h to prove the inside has the border's value, else the
+ *           rectangle is cut like a mixed one. The proof is about julia() on the
+ *           full view, which is what fn has to compute, and makes the result match
+ *           kernel_serial exactly.
+ *
+ */
+
+#ifndef __MARIANI_SILVER_H__
+#define __MARIANI_SILVER_H__
+
+#include <omp.h>
+#include "fractal.h"
+#include "interval.h"
+
+#define MS_MIN_SIZE 6           //rectangles this thin are just computed pixel by pixel
+#define MS_TASK_SIZE 32         //smaller rectangles are finished by the task that found them
+
+//evaluates the unknown pixels of a row or column segment, returns how many were computed
+template <typename PixelFn>
+inline long long ms_compute_line( int *vals, int x0, int y0, int dx, int dy, int n, PixelFn &fn ) {
+    long long calls = 0;
+    for (int k=0; k<n; k++) {
+        int x = x0 + k*dx, y = y0 + k*dy;
+        if (vals[x + y*DIM] < 0) {
+            vals[x + y*DIM] = fn(x, y);
+            calls++;
+        }
+    }
+    return calls;
+}
+
+//true when every border pixel of the rectangle has the value of its corner
+inline bool ms_border_uniform( const int *vals, int x0, int y0, int x1, int y1 ) {
+    int v = vals[x0 + y0*DIM];
+    for (int x=x0; x<=x1; x++) {
+        if (vals[x + y0*DIM] != v || vals[x + y1*DIM] != v)
+            return false;
+    }
+    for (int y=y0; y<=y1; y++) {
+        if (vals[x0 + y*DIM] != v || vals[x1 + y*DIM] != v)
+            return false;
+    }
+    return true;
+}
+
+//handles the rectangle [x0, x1] x [y0, y1] whose border is already known
+//calls is a pointer so every task adds to the same counter
+template <typename PixelFn>
+void ms_rect( int *vals, int x0, int y0, int x1, int y1, PixelFn &fn, long long *calls ) {
+    if (x1 - x0 < 2 || y1 - y0 < 2)
+        return; //no inside left
+
+    int v = vals[x0 + y0*DIM];
+    if (ms_border_uniform(vals, x0, y0, x1, y1) &&
+        classify_tile(x0+1, y0+1, x1, y1) == (v ? TILE_BOUNDED : TILE_ESCAPES)) {
+        for (int y=y0+1; y<y1; y++)
+            for (int x=x0+1; x<x1; x++)
+                vals[x + y*DIM] = v;
+        return;
+    }
+
+    long long mine = 0;
+    if (x1 - x0 <= MS_MIN_SIZE || y1 - y0 <= MS_MIN_SIZE) {
+        for (int y=y0+1; y<y1; y++)
+            mine += ms_compute_line(vals, x0+1, y, 1, 0, x1-x0-1, fn);
+        #pragma omp atomic
+        *calls += mine;
+        return;
+    }
+
+    //cut the longer side in the middle, the cut line becomes the shared border of the halves
+    bool big = (x1 - x0) * (y1 - y0) > MS_TASK_SIZE * MS_TASK_SIZE;
+    if (x1 - x0 >= y1 - y0) {
+        int xm = (x0 + x1) / 2;
+        mine += ms_compute_line(vals, xm, y0+1, 0, 1, y1-y0-1, fn);
+        #pragma omp atomic
+        *calls += mine;
+        #pragma omp task if(big)
+        ms_rect(vals, x0, y0, xm, y1, fn, calls);
+        #pragma omp task if(big)
+        ms_rect(vals, xm, y0, x1, y1, fn, calls);
+    } else {
+        int ym = (y0 + y1) / 2;
+        mine += ms_compute_line(vals, x0+1, ym, 1, 0, x1-x0-1, fn);
+        #pragma omp atomic
+        *calls += mine;
+        #pragma omp task if(big)
+        ms_rect(vals, x0, y0, x1, ym, fn, calls);
+        #pragma omp task if(big)
+        ms_rect(vals, x0, ym, x1, y1, fn, calls);
+    }
+}
+
+//fills vals (DIM*DIM) with fn(x, y) for every pixel using subdivision,
+//returns the number of fn calls that were actually made
+template <typename PixelFn>
+long long mariani_silver( int *vals, PixelFn fn ) {
+    long long calls = 0;
+    for (int k=0; k<DIM*DIM; k++)
+        vals[k] = -1;
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        //outer border of the image, the only part not computed as a cut line
+        long long border = 0;
+        border += ms_compute_line(vals, 0, 0, 1, 0, DIM, fn);
+        border += ms_compute_line(vals, 0, DIM-1, 1, 0, DIM, fn);
+        border += ms_compute_line(vals, 0, 0, 0, 1, DIM, fn);
+        border += ms_compute_line(vals, DIM-1, 0, 0, 1, DIM, fn);
+        calls += border;
+        ms_rect(vals, 0, 0, DIM-1, DIM-1, fn, &calls);
+    } //all tasks are done at the barrier here
+    return calls;
+}
+
+#endif  // __MARIANI_SILVER_H__
@@ -0,0 +1,112 @@
+/* File:     palette.h
+ *
+ * Purpose:  colouring split off from the compute. The compute pass only writes one
+ *           uint16 iteration count per pixel into a dense buffer, the colour pass
+ *           then maps every count through a palette lookup table of packed RGBA
+ *           values straight into the bitmap. Recolouring a finished render is just
+ *           another colour pass.
+ *
+ *           The colour pass gathers 8 (AVX2) or 16 (AVX-512) palette entries per
+ *           instruction, the ISA is picked with cpu_dispatch.h like the julia
+ *           kernels. SSE2 has no gather so it takes the scalar loop.
+ *
+ */
+
+#ifndef __PALETTE_H__
+#define __PALETTE_H__
+
+#include <stdint.h>
+#include <cstring>
+#include <immintrin.h>
+#include <omp.h>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "julia_precision.h"
+#include "cpu_dispatch.h"
+
+//count stored for pixels that never escape, escaped pixels store the iterations they ran
+//(1 .. MAX_ITER, the escaping one included)
+#define ITER_INSIDE (MAX_ITER + 1)
+#define PALETTE_SIZE (MAX_ITER + 2)
+
+struct Palette {
+    uint32_t    lut[PALETTE_SIZE];  //rgba bytes of each count packed like the bitmap stores them
+};
+
+inline uint32_t pack_rgba( unsigned char r, unsigned char g, unsigned char b, unsigned char a ) {
+    unsigned char bytes[4] = { r, g, b, a };
+    uint32_t v;
+    memcpy(&v, bytes, 4);
+    return v;
+}
+
+//red inside and black outside, gives exactly the image of julia()
+inline void palette_binary( Palette &p ) {
+    for (int n=0; n<PALETTE_SIZE; n++)
+        p.lut[n] = pack_rgba(n == ITER_INSIDE ? 255 : 0, 0, 0, 255);
+}
+
+//black through red to yellow as t goes from 0 to 1
+inline uint32_t gradient_rgba( float t ) {
+    float r = t < 0.5f ? 2.0f * t : 1.0f;
+    float g = t < 0.5f ? 0.0f : 2.0f * t - 1.0f;
+    return pack_rgba((unsigned char)(255 * r), (unsigned char)(255 * g), 0, 255);
+}
+
+//escaped pixels go along the gradient as they take longer, inside stays red
+inline void palette_gradient( Palette &p ) {
+    for (int n=0; n<ITER_INSIDE; n++)
+        p.lut[n] = gradient_rgba((float)n / (ITER_INSIDE - 1));
+    p.lut[ITER_INSIDE] = pack_rgba(255, 0, 0, 255);
+}
+
+//the julia() escape loop returning the count instead of 0/1
+inline uint16_t julia_iterations( int x, int y ) {
+    cuComplex a(pixel_coord(x), pixel_coord(y));
+    NoWatch watch;
+    int n;
+    return escape_orbit(a, MAX_ITER, watch, n) ? n : ITER_INSIDE;
+}
+
+//colours the pixels begin .. end-1 of the count buffer
+inline void colour_scalar( const uint16_t *iters, const Palette &p, uint32_t *out, int begin, int end ) {
+    for (int k=begin; k<end; k++)
+        out[k] = p.lut[iters[k]];
+}
+
+__attribute__((target("avx2")))
+inline void colour_avx2( const uint16_t *iters, const Palette &p, uint32_t *out, int begin, int end ) {
+    int k = begin;
+    for (; k + 8 <= end; k += 8) {
+        __m256i idx = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(iters + k)));
+        __m256i rgba = _mm256_i32gather_epi32((const int *)p.lut, idx, 4);
+        _mm256_storeu_si256((__m256i *)(out + k), rgba);
+    }
+    colour_scalar(iters, p, out, k, end);
+}
+
+__attribute__((target("avx512f")))
+inline void colour_avx512( const uint16_t *iters, const Palette &p, uint32_t *out, int begin, int end ) {
+    int k = begin;
+    for (; k + 16 <= end; k += 16) {
+        __m512i idx = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)(iters + k)));
+        __m512i rgba = _mm512_i32gather_epi32(idx, (const void *)p.lut, 4);
+        _mm512_storeu_si512(out + k, rgba);
+    }
+    colour_scalar(iters, p, out, k, end);
+}
+
+//colour pass over the whole image, rows are shared out statically since every pixel costs the same
+inline void colour_pass( Isa isa, const uint16_t *iters, const Palette &p, unsigned char *ptr ) {
+    uint32_t *out = (uint32_t *)ptr;
+    #pragma omp parallel for schedule(static)
+    for (int y=0; y<DIM; y++) {
+        switch (isa) {
+            case ISA_AVX512: colour_avx512( iters, p, out, y * DIM, (y + 1) * DIM ); break;
+            case ISA_AVX2:   colour_avx2( iters, p, out, y * DIM, (y + 1) * DIM ); break;
+            default:         colour_scalar( iters, p, out, y * DIM, (y + 1) * DIM ); break;
+        }
+    }
+}
+
+#endif  // __PALETTE_H__
@@ -0,0 +1,96 @@
+/* File:     partition.h
+ *
+ * Purpose:  equal work partitioning from a cheap preview. The rowblock kernel gives
+ *           every thread the same number of rows, but a row costs anything from
+ *           DIM to DIM * MAX_ITER iterations. Here a 1/PREVIEW_FACTOR resolution
+ *           preview of iteration counts (1/64 of the pixels) estimates the cost of
+ *           every row, and the rows are cut into contiguous ranges of equal
+ *           predicted cost, which the threads then run statically.
+ *
+ *           cost_partition() only sees a list of costs, so it works just as well for
+ *           tiles in any fixed order as for rows. CostPartitionRows is the row version
+ *           as a decomposition policy for render() (render_driver.h).
+ *
+ */
+
+#ifndef __PARTITION_H__
+#define __PARTITION_H__
+
+#include <vector>
+#include <omp.h>
+#include "fractal.h"
+#include "palette.h"
+
+#define PREVIEW_FACTOR 8    //preview pixel spacing, DIM has to be a multiple of it
+
+//predicted cost of every full resolution row: each preview pixel stands for a
+//PREVIEW_FACTOR x PREVIEW_FACTOR block and costs its iteration count
+inline void preview_row_costs( std::vector<double> &row_cost ) {
+    const int n = DIM / PREVIEW_FACTOR;
+    row_cost.assign(DIM, 0.0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int py=0; py<n; py++) {
+        double cost = 0.0;
+        for (int px=0; px<n; px++)
+            cost += julia_iterations(px * PREVIEW_FACTOR + PREVIEW_FACTOR/2, py * PREVIEW_FACTOR + PREVIEW_FACTOR/2);
+        for (int y=py * PREVIEW_FACTOR; y<(py + 1) * PREVIEW_FACTOR; y++)
+            row_cost[y] = cost; //only relative costs matter, so no scaling up to the full row width
+    }
+}
+
+//cuts items 0 .. n-1 into parts contiguous ranges of about equal total cost,
+//part t gets [bounds[t], bounds[t+1]) and predicted[t] its total cost
+inline void cost_partition( const std::vector<double> &cost, int parts,
+                            std::vector<int> &bounds, std::vector<double> &predicted ) {
+    int n = (int)cost.size();
+    double total = 0.0;
+    for (int k=0; k<n; k++)
+        total += cost[k];
+
+    bounds.assign(parts + 1, n);
+    predicted.assign(parts, 0.0);
+    bounds[0] = 0;
+    double sum = 0.0;
+    int k = 0;
+    for (int t=0; t<parts; t++) {
+        //take items until this part reaches its share of the cumulative total,
+        //an item goes to the side of the cut it is mostly on
+        double target = total * (t + 1) / parts;
+        while (k < n && (t == parts - 1 || sum + cost[k] / 2 <= target)) {
+            sum += cost[k];
+            predicted[t] += cost[k];
+            k++;
+        }
+        bounds[t + 1] = k;
+    }
+}
+
+//render() policy: the rows cut by cost_partition() into one range per thread of the team
+//that really started, predicted gets each range's cost and actual each thread's seconds
+struct CostPartitionRows {
+    const std::vector<double>   &row_cost;
+    std::vector<int>            &bounds;
+    std::vector<double>         &predicted, &actual;
+
+    CostPartitionRows( const std::vector<double> &cost, std::vector<int> &b,
+                       std::vector<double> &p, std::vector<double> &a )
+        : row_cost(cost), bounds(b), predicted(p), actual(a) {}
+
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        #pragma omp single
+        {
+            cost_partition( row_cost, nthreads, bounds, predicted );
+            actual.assign(nthreads, 0.0);
+        }
+        double start = omp_get_wtime();
+        for (int y=bounds[tid]; y<bounds[tid + 1]; y++) {
+            for (int x=0; x<DIM; x++)
+                visit(x, y);
+        }
+        actual[tid] = omp_get_wtime() - start;
+    }
+};
+
+#endif  // __PARTITION_H__
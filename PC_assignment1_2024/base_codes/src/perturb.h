@@ -0,0 +1,282 @@
+/* File:     perturb.h
+ *
+ * Purpose:  perturbation rendering for deep zooms. One reference orbit
+ *           Z_{n+1} = Z_n^2 + c is iterated in high precision (double-double, or
+ *           fixed_mp.h when that is not enough) from the centre of
+ *           the viewport, every pixel then only iterates its small offset from it
+ *
+ *               d_{n+1} = 2 Z_n d_n + d_n^2        (c is the same for every pixel)
+ *
+ *           in plain double, and escapes when |Z_n + d_n|^2 > BAILOUT like julia().
+ *
+ *           Where d_n gets large compared to Z_n the low precision delta can no
+ *           longer follow the pixel and the image gets "glitched" blobs. Those pixels
+ *           are detected with Pauldelbrot's test |Z_n + d_n|^2 < GLITCH_TOL |Z_n|^2,
+ *           grouped into regions and rendered again against a new reference picked
+ *           inside each region until no glitched pixels are left.
+ *
+ *           With a BLA table (bla.h) for the reference, pixels whose delta is still
+ *           tiny jump over whole blocks of iterations instead of walking every one.
+ *
+ */
+
+#ifndef __PERTURB_H__
+#define __PERTURB_H__
+
+#include <vector>
+#include <cmath>
+#include <omp.h>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "viewport.h"
+#include "julia_precision.h"
+#include "bla.h"
+#include "fixed_mp.h"
+
+//julia_perturb() result for pixels whose delta lost too much precision
+#define PERTURB_GLITCH -1
+//Pauldelbrot's tolerance, a pixel is glitched once |Z + d|^2 < GLITCH_TOL |Z|^2
+#define GLITCH_TOL 1e-6
+//rounds of new references before the leftovers are computed directly in double-double
+#define GLITCH_MAX_ROUNDS 32
+
+struct ReferenceOrbit {
+    std::vector<double> zr;     //Z_n rounded to double, n = 0 .. length
+    std::vector<double> zi;
+    int length;                 //iteration at which the reference escaped (MAX_ITER if it never did)
+    int ref_x, ref_y;           //pixel the orbit starts from, the centre DIM/2 for the main reference
+    int bits;                   //mantissa bits the orbit was iterated with
+};
+
+struct PerturbStats {
+    int glitched;               //pixels the main reference could not render
+    int references;             //extra references used to fix them
+    int rounds;                 //passes of the glitch loop
+    int direct;                 //pixels that were still glitched after GLITCH_MAX_ROUNDS
+    long long bla_skipped;      //iterations saved by BLA jumps over the whole frame
+    int reference_bits;         //precision of the main reference orbit
+};
+
+//iterates the reference in N limb fixed point, the start is the typed centre plus the
+//pixel's offset from it so no digit of the centre is lost
+template <int N>
+inline void fixed_reference_orbit( ReferenceOrbit &ref, const Viewport &view, int ref_x, int ref_y ) {
+    FixedMP<N> sr = fixed_from_string<N>(view.cx_text.c_str())
+                  + fixed_from_double<N>(view.half_width * (double)(DIM/2 - ref_x)/(DIM/2));
+    FixedMP<N> si = fixed_from_string<N>(view.cy_text.c_str())
+                  + fixed_from_double<N>(view.half_width * (double)(DIM/2 - ref_y)/(DIM/2));
+    ref.length = iterate_fixed_orbit<N>(sr, si, MAX_ITER, ref.zr, ref.zi);
+    ref.bits = 32 * (N-1);
+}
+
+//iterates pixel (ref_x, ref_y) of the viewport and stores the orbit, in double-double
+//while that resolves the viewport and in the smallest fixed point type that does otherwise
+inline void compute_reference_orbit( ReferenceOrbit &ref, const Viewport &view,
+                                     int ref_x = DIM/2, int ref_y = DIM/2 ) {
+    ref.ref_x = ref_x;
+    ref.ref_y = ref_y;
+
+    int bits = precision_bits_needed(view);
+    if (bits > precision_bits[PREC_DD]) {
+        if (bits <= 32 * 7)
+            fixed_reference_orbit<8>(ref, view, ref_x, ref_y);
+        else if (bits <= 32 * 15)
+            fixed_reference_orbit<16>(ref, view, ref_x, ref_y);
+        else
+            fixed_reference_orbit<32>(ref, view, ref_x, ref_y);
+        return;
+    }
+
+    cuComplexT<dd_real> c(dd_real(JULIA_CR), dd_real(JULIA_CI));
+    dd_real sr, si;
+    view_coord<dd_real>(view, ref_x, ref_y, sr, si);
+    cuComplexT<dd_real> a(sr, si);
+    const dd_real bailout(BAILOUT);
+
+    ref.bits = precision_bits[PREC_DD];
+    ref.zr.assign(1, to_double(a.r));
+    ref.zi.assign(1, to_double(a.i));
+    ref.length = MAX_ITER;
+    for (int i=0; i<MAX_ITER; i++) {
+        a = a * a + c;
+        ref.zr.push_back(to_double(a.r));
+        ref.zi.push_back(to_double(a.i));
+        if (a.magnitude2() > bailout) {
+            ref.length = i + 1;
+            break;
+        }
+    }
+}
+
+//offset of pixel (x, y) from the reference pixel, small numbers so double is enough
+inline void pixel_delta( const Viewport &view, const ReferenceOrbit &ref, int x, int y, double &dx, double &dy ) {
+    dx = view.half_width * (double)(ref.ref_x - x)/(DIM/2);
+    dy = view.half_width * (double)(ref.ref_y - y)/(DIM/2);
+}
+
+//same result as julia_t() for the pixel (x, y) of the viewport the reference was computed for,
+//or PERTURB_GLITCH when the delta can no longer be trusted
+//bla (optional) is the table of the same reference, skipped counts the iterations it saved
+//if the reference escapes before the pixel does we carry on with the full value in double,
+//by then the orbit is far from the reference and its digits no longer need the extra precision
+inline int julia_perturb( int x, int y, const Viewport &view, const ReferenceOrbit &ref,
+                          const BlaTable *bla = NULL, long long *skipped = NULL ) {
+    double dr, di;
+    pixel_delta(view, ref, x, y, dr, di);
+
+    int limit = std::min(MAX_ITER, ref.length);
+    int n = 0;
+    while (n < limit) {
+        int k = bla ? bla_lookup(*bla, n, dr, di, limit) : 0;
+        if (k > 0) {
+            //d_{n+2^k} = A d_n
+            const BlaEntry &e = bla->levels[k][n >> k];
+            double nr = e.ar * dr - e.ai * di;
+            double ni = e.ar * di + e.ai * dr;
+            dr = nr;
+            di = ni;
+            n += 1 << k;
+            if (skipped)
+                *skipped += (1 << k) - 1;
+        } else {
+            double Zr = ref.zr[n], Zi = ref.zi[n];
+            //d = 2 Z d + d^2
+            double nr = 2.0 * (Zr * dr - Zi * di) + (dr * dr - di * di);
+            double ni = 2.0 * (Zr * di + Zi * dr) + 2.0 * dr * di;
+            dr = nr;
+            di = ni;
+            n++;
+        }
+
+        double Zr1 = ref.zr[n], Zi1 = ref.zi[n];
+        double zr = Zr1 + dr, zi = Zi1 + di;
+        double mag = zr * zr + zi * zi;
+        if (mag > BAILOUT)
+            return 0;
+        if (mag < GLITCH_TOL * (Zr1 * Zr1 + Zi1 * Zi1))
+            return PERTURB_GLITCH;
+    }
+    if (n == MAX_ITER)
+        return 1;
+
+    //reference ran out, finish the orbit directly
+    cuComplexT<double> c(JULIA_CR, JULIA_CI);
+    cuComplexT<double> a(ref.zr[n] + dr, ref.zi[n] + di);
+    for (; n < MAX_ITER; n++) {
+        a = a * a + c;
+        if (a.magnitude2() > BAILOUT)
+            return 0;
+    }
+    return 1;
+}
+
+//splits the glitched pixels into 4-connected regions, label[offset] gets the region
+//number of each glitched pixel (-1 elsewhere), returns the number of regions
+inline int label_glitch_regions( const std::vector<int> &pixels, std::vector<int> &label ) {
+    label.assign(DIM*DIM, -1);
+    for (size_t k=0; k<pixels.size(); k++)
+        label[pixels[k]] = -2; //glitched but not labelled yet
+
+    int regions = 0;
+    std::vector<int> stack;
+    for (size_t k=0; k<pixels.size(); k++) {
+        if (label[pixels[k]] != -2)
+            continue;
+        label[pixels[k]] = regions;
+        stack.push_back(pixels[k]);
+        while (!stack.empty()) {
+            int offset = stack.back();
+            stack.pop_back();
+            int x = offset % DIM, y = offset / DIM;
+            int nb[4] = { x > 0 ? offset - 1 : -1, x < DIM-1 ? offset + 1 : -1,
+                          y > 0 ? offset - DIM : -1, y < DIM-1 ? offset + DIM : -1 };
+            for (int j=0; j<4; j++) {
+                if (nb[j] >= 0 && label[nb[j]] == -2) {
+                    label[nb[j]] = regions;
+                    stack.push_back(nb[j]);
+                }
+            }
+        }
+        regions++;
+    }
+    return regions;
+}
+
+//renders the glitched pixels again until none are left: every round picks one new
+//reference per connected glitch region (the region pixel nearest its centroid), computes
+//the references in parallel and then re-renders the pixels in parallel against them
+//results[k] gets the 0/1 value of pixel glitched[k]
+inline void resolve_glitches( const std::vector<int> &glitched, const Viewport &view,
+                              std::vector<int> &results, PerturbStats &stats ) {
+    results.assign(glitched.size(), 0);
+    stats.glitched = (int)glitched.size();
+    stats.references = 0;
+    stats.rounds = 0;
+    stats.direct = 0;
+    stats.bla_skipped = 0;
+
+    std::vector<int> pending(glitched.size()); //indices into glitched still to be rendered
+    for (size_t k=0; k<pending.size(); k++)
+        pending[k] = (int)k;
+
+    std::vector<int> label;
+    while (!pending.empty() && stats.rounds < GLITCH_MAX_ROUNDS) {
+        std::vector<int> pixels(pending.size());
+        for (size_t k=0; k<pending.size(); k++)
+            pixels[k] = glitched[pending[k]];
+        int regions = label_glitch_regions(pixels, label);
+
+        //centroid of every region, then its closest member becomes the reference
+        std::vector<double> sx(regions, 0.0), sy(regions, 0.0), best_d(regions, HUGE_VAL);
+        std::vector<int> count(regions, 0), best(regions, -1);
+        for (size_t k=0; k<pixels.size(); k++) {
+            int r = label[pixels[k]];
+            sx[r] += pixels[k] % DIM;
+            sy[r] += pixels[k] / DIM;
+            count[r]++;
+        }
+        for (size_t k=0; k<pixels.size(); k++) {
+            int r = label[pixels[k]];
+            double dx = pixels[k] % DIM - sx[r] / count[r];
+            double dy = pixels[k] / DIM - sy[r] / count[r];
+            if (dx * dx + dy * dy < best_d[r]) {
+                best_d[r] = dx * dx + dy * dy;
+                best[r] = pixels[k];
+            }
+        }
+
+        std::vector<ReferenceOrbit> refs(regions);
+        #pragma omp parallel for schedule(dynamic)
+        for (int r=0; r<regions; r++)
+            compute_reference_orbit(refs[r], view, best[r] % DIM, best[r] / DIM);
+
+        std::vector<int> still(pending.size());
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t k=0; k<pending.size(); k++) {
+            int offset = glitched[pending[k]];
+            int value = julia_perturb(offset % DIM, offset / DIM, view, refs[label[offset]]);
+            still[k] = value == PERTURB_GLITCH;
+            if (!still[k])
+                results[pending[k]] = value;
+        }
+
+        std::vector<int> next;
+        for (size_t k=0; k<pending.size(); k++) {
+            if (still[k])
+                next.push_back(pending[k]);
+        }
+        pending.swap(next);
+        stats.references += regions;
+        stats.rounds++;
+    }
+
+    //should not happen (a reference pixel can not glitch against itself) but never leave holes
+    stats.direct = (int)pending.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t k=0; k<pending.size(); k++) {
+        int offset = glitched[pending[k]];
+        results[pending[k]] = julia_t<dd_real>(offset % DIM, offset / DIM, view);
+    }
+}
+
+#endif  // __PERTURB_H__
@@ -0,0 +1,126 @@
+/* File:     progressive.h
+ *
+ * Purpose:  progressive coarse to fine rendering. The first pass computes every
+ *           16th pixel in both directions, every following pass halves the spacing
+ *           (8, 4, 2, 1) and only adds the pixels that are new at that spacing, so
+ *           nothing is ever computed twice. After each pass the image can be shown
+ *           with every known pixel drawn as a block of the current spacing.
+ *
+ *           Solid guessing (like Fractint): a new pixel lies inside a cell of the
+ *           previous pass. If the 4x4 previous pass pixels of that cell and the ring
+ *           of cells around it all agree, the pixel just gets their value instead of
+ *           being computed. Strict mode turns guessing off and gives exactly the
+ *           full render.
+ *
+ */
+
+#ifndef __PROGRESSIVE_H__
+#define __PROGRESSIVE_H__
+
+#include <omp.h>
+#include "fractal.h"
+#include "render_driver.h"
+
+#define PROGRESSIVE_START 16    //spacing of the first pass, a power of two that divides DIM
+
+struct ProgressiveRender {
+    int         *vals;          //DIM*DIM values, valid on the lattice of the last pass
+    int         step;           //spacing of the last finished pass, 0 before the first one
+    bool        strict;         //never guess
+    long long   computed;       //pixels evaluated so far
+    long long   guessed;        //pixels filled by solid guessing so far
+};
+
+inline void progressive_begin( ProgressiveRender &pr, int *vals, bool strict ) {
+    pr.vals = vals;
+    pr.step = 0;
+    pr.strict = strict;
+    pr.computed = 0;
+    pr.guessed = 0;
+}
+
+inline bool progressive_done( const ProgressiveRender &pr ) {
+    return pr.step == 1;
+}
+
+//true when the previous pass pixels of the cell with corner (px, py) and of the ring of
+//cells around it are all inside the image and equal, v gets their value
+inline bool progressive_guess( const int *vals, int px, int py, int p, int &v ) {
+    if (px - p < 0 || py - p < 0 || px + 2*p >= DIM || py + 2*p >= DIM)
+        return false;
+    v = vals[px + py*DIM];
+    for (int j=-1; j<=2; j++) {
+        for (int i=-1; i<=2; i++) {
+            if (vals[(px + i*p) + (py + j*p)*DIM] != v)
+                return false;
+        }
+    }
+    return true;
+}
+
+//runs the next pass, returns false when the image was already complete
+template <typename PixelFn>
+bool progressive_next_pass( ProgressiveRender &pr, PixelFn fn ) {
+    if (progressive_done(pr))
+        return false;
+
+    int *vals = pr.vals;
+    long long computed = 0, guessed = 0;
+
+    if (pr.step == 0) {
+        const int s = PROGRESSIVE_START;
+        #pragma omp parallel for schedule(dynamic) reduction(+:computed)
+        for (int y=0; y<DIM; y+=s) {
+            for (int x=0; x<DIM; x+=s) {
+                vals[x + y*DIM] = fn(x, y);
+                computed++;
+            }
+        }
+        pr.step = s;
+    } else {
+        //new pixels only read pixels of earlier passes, so the rows are independent
+        const int s = pr.step / 2, p = pr.step;
+        const bool strict = pr.strict;
+        #pragma omp parallel for schedule(dynamic) reduction(+:computed,guessed)
+        for (int y=0; y<DIM; y+=s) {
+            for (int x=0; x<DIM; x+=s) {
+                if (x % p == 0 && y % p == 0)
+                    continue; //known from an earlier pass
+
+                int v;
+                if (!strict && progressive_guess(vals, x - x % p, y - y % p, p, v)) {
+                    vals[x + y*DIM] = v;
+                    guessed++;
+                } else {
+                    vals[x + y*DIM] = fn(x, y);
+                    computed++;
+                }
+            }
+        }
+        pr.step = s;
+    }
+
+    pr.computed += computed;
+    pr.guessed += guessed;
+    return true;
+}
+
+//value shown at pixel (x, y) after the last pass: the lattice point of its block
+inline int progressive_value( const ProgressiveRender &pr, int x, int y ) {
+    int s = pr.step;
+    return pr.vals[(x - x % s) + (y - y % s)*DIM];
+}
+
+//writes the image as it stands after the last progressive pass, every known
+//pixel is drawn as a block of the current spacing
+//works for both CPUBitmap and CPUAnimBitmap pixels
+inline void publish_progressive( unsigned char *ptr, const ProgressiveRender &pr ) {
+    RgbaWriter writer( ptr );
+    #pragma omp parallel for schedule(static)
+    for (int y=0; y<DIM; y++) {
+        for (int x=0; x<DIM; x++)
+            writer.write( x, y, pr.step ? progressive_value( pr, x, y ) : 0 );
+    }
+}
+
+#endif  // __PROGRESSIVE_H__
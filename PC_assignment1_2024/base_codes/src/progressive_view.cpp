@@ -0,0 +1,37 @@
+/* File:     progressive_view.cpp
+ *
+ * Purpose:  the window behind --progressive, see progressive_view.h
+ *
+ */
+
+#include <cstdlib>
+#include "../common/cpu_anim.h"
+#include <omp.h>
+#include "fractal.h"
+#include "progressive.h"
+#include "progressive_view.h"
+
+//state of the interactive progressive display, one pass is run per animation frame
+struct ProgressiveAnim {
+    ProgressiveRender   pr;
+    CPUAnimBitmap       *bitmap;
+};
+
+static void progressive_anim_frame ( void *data, int ticks ){
+    ProgressiveAnim *anim = (ProgressiveAnim *)data;
+    if (progressive_next_pass( anim->pr, [](int x, int y) { return julia( x, y ); } ))
+        publish_progressive( anim->bitmap->get_ptr(), anim->pr );
+}
+
+static void progressive_anim_exit ( void *data ){
+    delete [] ((ProgressiveAnim *)data)->pr.vals;
+}
+
+void progressive_display_and_exit( bool strict ){
+    ProgressiveAnim anim;
+    CPUAnimBitmap anim_bitmap( DIM, DIM, &anim );
+    anim.bitmap = &anim_bitmap;
+    progressive_begin( anim.pr, new int[DIM*DIM], strict );
+    publish_progressive( anim_bitmap.get_ptr(), anim.pr ); //black until the first pass is in
+    anim_bitmap.anim_and_exit( progressive_anim_frame, progressive_anim_exit );
+}
@@ -0,0 +1,16 @@
+/* File:     progressive_view.h
+ *
+ * Purpose:  interactive progressive display of the full view, one refining pass per
+ *           animation frame. It lives in progressive_view.cpp so the book's
+ *           cpu_anim.h (and its GL setup) stays out of fractal.cpp.
+ *
+ */
+
+#ifndef __PROGRESSIVE_VIEW_H__
+#define __PROGRESSIVE_VIEW_H__
+
+//opens the window and refines the image pass by pass until it is closed, strict turns
+//solid guessing off. Never returns, like CPUBitmap::display_and_exit()
+void progressive_display_and_exit( bool strict );
+
+#endif  // __PROGRESSIVE_VIEW_H__
@@ -0,0 +1,159 @@
+/* File:     render_driver.h
+ *
+ * Purpose:  one render loop for all the plain decompositions. render() is
+ *           templated on
+ *
+ *             - a decomposition policy that calls visit(x, y) for the pixels one
+ *               thread owns (cyclic rows or columns, row or column blocks, 2D
+ *               block-cyclic tiles, collapsed omp for, dynamic rows)
+ *             - the pixel function, a function object type like JuliaPixel in
+ *               fractal.cpp (a plain function would come in as a pointer and be
+ *               called through it for every pixel)
+ *             - the writer that stores a pixel value
+ *
+ *           and everything is resolved at compile time, so the inner loop has no
+ *           function pointers or virtual calls. A new decomposition is a new policy
+ *           struct with a run() member, like CostPartitionRows in partition.h and
+ *           WorkStealTiles in work_steal.h.
+ *
+ *           RgbaWriter is also how the kernels that keep their own loop (they sum
+ *           iterations or only touch some pixels) store a pixel.
+ *
+ */
+
+#ifndef __RENDER_DRIVER_H__
+#define __RENDER_DRIVER_H__
+
+#include <omp.h>
+#include "fractal.h"
+
+//rows tid, tid + n, tid + 2n, ...
+struct CyclicRows {
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        for (int y=tid; y<DIM; y+=nthreads) {
+            for (int x=0; x<DIM; x++)
+                visit(x, y);
+        }
+    }
+};
+
+//one contiguous range of rows per thread, the DIM % n leftover rows go one each to the first threads
+struct BlockRows {
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        int rows = DIM / nthreads, extra = DIM % nthreads;
+        int begin = tid * rows + (tid < extra ? tid : extra);
+        int end = begin + rows + (tid < extra ? 1 : 0);
+        for (int y=begin; y<end; y++) {
+            for (int x=0; x<DIM; x++)
+                visit(x, y);
+        }
+    }
+};
+
+//columns tid, tid + n, ... walked top to bottom, so consecutive writes are a row apart
+struct CyclicCols {
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        for (int x=tid; x<DIM; x+=nthreads) {
+            for (int y=0; y<DIM; y++)
+                visit(x, y);
+        }
+    }
+};
+
+//one contiguous range of columns per thread, walked column by column
+struct BlockCols {
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        int cols = DIM / nthreads, extra = DIM % nthreads;
+        int begin = tid * cols + (tid < extra ? tid : extra);
+        int end = begin + cols + (tid < extra ? 1 : 0);
+        for (int x=begin; x<end; x++) {
+            for (int y=0; y<DIM; y++)
+                visit(x, y);
+        }
+    }
+};
+
+//tile_w x tile_h tiles numbered row major, tile k goes to thread k % n
+struct BlockCyclic2D {
+    int tile_w, tile_h;
+    BlockCyclic2D( int w, int h ) : tile_w(w), tile_h(h) {}
+
+    template <typename Visit>
+    void run( int tid, int nthreads, Visit &visit ) const {
+        int tiles_x = (DIM + tile_w - 1) / tile_w, tiles_y = (DIM + tile_h - 1) / tile_h;
+        for (int t=tid; t<tiles_x*tiles_y; t+=nthreads) {
+            int x0 = (t % tiles_x) * tile_w, y0 = (t / tiles_x) * tile_h;
+            int x1 = x0 + tile_w < DIM ? x0 + tile_w : DIM;
+            int y1 = y0 + tile_h < DIM ? y0 + tile_h : DIM;
+            for (int y=y0; y<y1; y++) {
+                for (int x=x0; x<x1; x++)
+                    visit(x, y);
+            }
+        }
+    }
+};
+
+//omp for collapse(2) schedule(static) over every pixel, the runtime cuts the DIM*DIM
+//iterations into one contiguous range per thread
+struct CollapsedPixels {
+    template <typename Visit>
+    void run( int, int, Visit &visit ) const {
+        #pragma omp for collapse(2) schedule(static)
+        for (int y=0; y<DIM; y++) {
+            for (int x=0; x<DIM; x++)
+                visit(x, y);
+        }
+    }
+};
+
+//rows handed out one at a time to whichever thread is free
+struct DynamicRows {
+    template <typename Visit>
+    void run( int, int, Visit &visit ) const {
+        #pragma omp for schedule(dynamic)
+        for (int y=0; y<DIM; y++) {
+            for (int x=0; x<DIM; x++)
+                visit(x, y);
+        }
+    }
+};
+
+//the red/black image every kernel draws
+struct RgbaWriter {
+    unsigned char *ptr;
+    RgbaWriter( unsigned char *p ) : ptr(p) {}
+
+    void write( int x, int y, int value ) const {
+        int offset = x + y * DIM;
+        ptr[offset*4 + 0] = 255 * value;
+        ptr[offset*4 + 1] = 0;
+        ptr[offset*4 + 2] = 0;
+        ptr[offset*4 + 3] = 255;
+    }
+
+    //red as a fraction 0 .. 1 of full, for coverage and smooth counts
+    void write_level( int x, int y, float level ) const {
+        int offset = x + y * DIM;
+        ptr[offset*4 + 0] = (unsigned char)(255 * level);
+        ptr[offset*4 + 1] = 0;
+        ptr[offset*4 + 2] = 0;
+        ptr[offset*4 + 3] = 255;
+    }
+};
+
+//renders the image with policy on threads threads, every thread asks the runtime for its
+//own id and the team size so nothing shared is written in the region
+template <typename Policy, typename PixelFn, typename Writer>
+void render( const Policy &policy, PixelFn pixel, const Writer &writer, int threads ) {
+    #pragma omp parallel num_threads(threads)
+    {
+        auto visit = [&](int x, int y) { writer.write(x, y, pixel(x, y)); };
+        policy.run(omp_get_thread_num(), omp_get_num_threads(), visit);
+    }
+}
+
+#endif  // __RENDER_DRIVER_H__
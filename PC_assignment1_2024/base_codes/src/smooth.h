@@ -0,0 +1,101 @@
+/* File:     smooth.h
+ *
+ * Purpose:  smooth (continuous) iteration count. When a pixel escapes after n steps
+ *           with |z| > R = sqrt(BAILOUT), the log-log correction
+ *
+ *               mu = n - log2( log|z| / log R )
+ *
+ *           runs continuously from n (|z| just over R) down to about n - 1 (|z|
+ *           near R^2, where it would have escaped a step earlier), so colouring by
+ *           mu has no bands. mu is stored normalised by MAX_ITER + 1, which keeps
+ *           every escaped pixel below 1.0, and pixels that never escape are exactly
+ *           1.0 - the 0/1 image of julia() is still in there.
+ *
+ *           The values live in a half precision (float16) buffer: 2 bytes a pixel
+ *           instead of 4, and 11 bits of mantissa are plenty for a colour index.
+ *
+ */
+
+#ifndef __SMOOTH_H__
+#define __SMOOTH_H__
+
+#include <stdint.h>
+#include <cstring>
+#include <cmath>
+#include "fractal.h"
+#include "cu_complex.h"
+#include "julia_precision.h"
+
+typedef uint16_t half;  //ieee 754 binary16 bits
+
+//float to half with round to nearest even, overflow goes to inf, tiny values to (sub)normals
+inline half float_to_half( float f ) {
+    uint32_t x;
+    memcpy(&x, &f, 4);
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t mag = x & 0x7FFFFFFF;
+
+    if (mag >= 0x7F800000) //inf or nan
+        return sign | 0x7C00 | (mag > 0x7F800000 ? 0x200 : 0);
+    if (mag >= 0x477FF000) //rounds to more than the largest half
+        return sign | 0x7C00;
+    if (mag < 0x38800000) { //below the smallest normal half
+        if (mag < 0x33000000)
+            return sign;
+        uint32_t shift = 126 - (mag >> 23); //14 .. 24
+        uint32_t m = (mag & 0x7FFFFF) | 0x800000;
+        uint32_t h = m >> shift;
+        uint32_t rest = m & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (h & 1)))
+            h++;
+        return sign | h;
+    }
+
+    uint32_t h = ((mag - 0x38000000) >> 13); //rebias 127 -> 15
+    uint32_t rest = mag & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+        h++; //a carry into the exponent is still the right answer
+    return sign | h;
+}
+
+inline float half_to_float( half h ) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t m = h & 0x3FF;
+    uint32_t x;
+
+    if (exp == 0x1F) {
+        x = sign | 0x7F800000 | (m << 13);
+    } else if (exp != 0) {
+        x = sign | ((exp + 112) << 23) | (m << 13);
+    } else if (m == 0) {
+        x = sign;
+    } else { //subnormal, normalise it
+        exp = 113;
+        while (!(m & 0x400)) {
+            m <<= 1;
+            exp--;
+        }
+        x = sign | (exp << 23) | ((m & 0x3FF) << 13);
+    }
+    float f;
+    memcpy(&f, &x, 4);
+    return f;
+}
+
+//same escape loop as julia() but returns the normalised smooth count in [0, 1),
+//or 1.0 when the pixel never escapes. n is the escape count that julia_iterations()
+//stores, so the smooth and palette images band at the same counts
+inline float julia_smooth( int x, int y ) {
+    cuComplex a(pixel_coord(x), pixel_coord(y));
+    NoWatch watch;
+    int n;
+    if (!escape_orbit(a, MAX_ITER, watch, n))
+        return 1.0f;
+
+    //log|z| / log R = log|z|^2 / log BAILOUT
+    float mu = n - log2f(logf(a.magnitude2()) / logf((float)BAILOUT));
+    return (mu > 0.0f ? mu : 0.0f) / (MAX_ITER + 1);
+}
+
+#endif  // __SMOOTH_H__
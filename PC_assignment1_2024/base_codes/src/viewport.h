@@ -0,0 +1,105 @@
+/* File:     viewport.h
+ *
+ * Purpose:  describes which part of the complex plane is rendered and decides
+ *           which floating point precision is needed to resolve its pixels.
+ *           The default viewport is the window julia() has always used:
+ *           centre 0 and [-1.5, 1.5] in both directions.
+ *
+ */
+
+#ifndef __VIEWPORT_H__
+#define __VIEWPORT_H__
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include "fractal.h"
+#include "double_double.h"
+
+struct Viewport {
+    dd_real cx;         //centre of the image, kept in double-double so deep zooms can be placed
+    dd_real cy;
+    double  half_width; //distance from the centre to the image edge (JULIA_SCALE / zoom)
+    std::string cx_text; //the centre as it was typed, so fixed_mp.h can read all of its digits
+    std::string cy_text;
+
+    Viewport( void ) : cx(0.0), cy(0.0), half_width(JULIA_SCALE), cx_text("0"), cy_text("0") {}
+
+    //distance between two neighbouring pixels on the complex plane
+    double pixel_spacing( void ) const { return half_width / (DIM/2); }
+
+    bool is_default( void ) const {
+        return cx.hi == 0.0 && cx.lo == 0.0 && cy.hi == 0.0 && cy.lo == 0.0 && half_width == JULIA_SCALE;
+    }
+};
+
+//converts a double-double to the scalar used by the escape loop
+template <typename T> inline T dd_to( const dd_real &a );
+template <> inline float dd_to<float>( const dd_real &a ) { return (float)a.hi; }
+template <> inline double dd_to<double>( const dd_real &a ) { return a.hi; }
+template <> inline long double dd_to<long double>( const dd_real &a ) { return (long double)a.hi + a.lo; }
+template <> inline dd_real dd_to<dd_real>( const dd_real &a ) { return a; }
+
+//distance from the image centre to pixel column or row p on the complex plane, p may
+//lie between two pixels for supersampling. Whole p are exact in every T, so in float
+//this is the scale * (DIM/2 - x) / (DIM/2) of julia()
+template <typename T, typename P>
+inline T pixel_offset( T half_width, P p ) {
+    return half_width * (T(DIM/2) - T(p))/T(DIM/2);
+}
+
+//maps pixel (x, y) to the complex plane the same way julia() does,
+//in float on the default viewport this gives exactly julia()'s jx and jy
+template <typename T>
+inline void view_coord( const Viewport &view, int x, int y, T &jx, T &jy ) {
+    const T scale = T(view.half_width);
+    jx = pixel_offset(scale, x) + dd_to<T>(view.cx);
+    jy = pixel_offset(scale, y) + dd_to<T>(view.cy);
+}
+
+//view_coord of the default view in float without building a Viewport, for the kernels
+//that always draw the full view: julia()'s jx for pixel_coord(x), jy for pixel_coord(y)
+inline float pixel_coord( float p ) {
+    return pixel_offset((float)JULIA_SCALE, p);
+}
+
+//scalar types the escape loop is instantiated for, cheapest first
+enum Precision { PREC_FLOAT = 0, PREC_DOUBLE, PREC_LONG_DOUBLE, PREC_DD, PREC_COUNT };
+
+static const char *precision_names[PREC_COUNT] = { "float", "double", "long_double", "dd" };
+
+//bits of mantissa of each precision
+static const int precision_bits[PREC_COUNT] = { 24, 53, 64, 106 };
+
+//bits kept on top of the pixel spacing to absorb the error growth of the iteration
+#define PRECISION_GUARD_BITS 10
+
+//bits of mantissa needed so that neighbouring pixels still map to different points
+inline int precision_bits_needed( const Viewport &view ) {
+    double extent = 2.0; //the orbit lives within |z| <= 2 until it escapes
+    extent = fmax(extent, fabs(view.cx.hi) + view.half_width);
+    extent = fmax(extent, fabs(view.cy.hi) + view.half_width);
+    return (int)ceil(log2(extent / view.pixel_spacing())) + PRECISION_GUARD_BITS;
+}
+
+//cheapest precision that can still resolve the viewport (dd if nothing is enough)
+inline Precision choose_precision( const Viewport &view ) {
+    int bits = precision_bits_needed(view);
+    for (int p = 0; p < PREC_COUNT; p++) {
+        if (precision_bits[p] >= bits)
+            return (Precision)p;
+    }
+    return PREC_DD;
+}
+
+inline bool parse_precision( const char *name, Precision *prec ) {
+    for (int i = 0; i < PREC_COUNT; i++) {
+        if (strcmp(name, precision_names[i]) == 0) {
+            *prec = (Precision)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif  // __VIEWPORT_H__
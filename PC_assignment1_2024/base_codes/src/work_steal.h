@@ -0,0 +1,154 @@
+/* File:     work_steal.h
+ *
+ * Purpose:  work stealing tile scheduler. The image is cut into tiles and every
+ *           thread gets its own deque of them (a contiguous block to start with,
+ *           like the rowblock kernel). A thread takes tiles from the back of its
+ *           own deque, and when that runs dry it steals from the front of the
+ *           other threads' deques, so the threads that got cheap tiles help out
+ *           the ones stuck on expensive ones instead of idling at the end.
+ *
+ *           Any kernel can use it: submit tiles, then pass WorkStealTiles as the
+ *           decomposition policy of render() (render_driver.h). Each deque has its
+ *           own omp lock, which is only contended while someone is stealing.
+ *
+ */
+
+#ifndef __WORK_STEAL_H__
+#define __WORK_STEAL_H__
+
+#include <deque>
+#include <vector>
+#include <omp.h>
+#include "fractal.h"
+
+#define WS_TILE 32  //tile width and height in pixels
+
+struct Tile {
+    int x0, y0, x1, y1;     //pixels [x0, x1) x [y0, y1)
+};
+
+struct TileDeque {
+    std::deque<Tile>    tiles;
+    omp_lock_t          lock;
+};
+
+//what each thread did during the last run
+struct WorkStealStats {
+    std::vector<double>     busy;       //seconds spent rendering tiles
+    std::vector<double>     idle;       //seconds of the run spent looking for work or waiting for the others
+    std::vector<int>        tiles;      //tiles rendered
+    std::vector<int>        stolen;     //of those, tiles taken from another thread
+};
+
+struct WorkStealScheduler {
+    int         threads;
+    TileDeque   *deques;
+
+    WorkStealScheduler( int n ) : threads(n) {
+        deques = new TileDeque[n];
+        for (int t=0; t<n; t++)
+            omp_init_lock(&deques[t].lock);
+    }
+
+    ~WorkStealScheduler() {
+        for (int t=0; t<threads; t++)
+            omp_destroy_lock(&deques[t].lock);
+        delete [] deques;
+    }
+};
+
+//queues a tile on the deque of thread t
+inline void ws_submit( WorkStealScheduler &s, int t, const Tile &tile ) {
+    omp_set_lock(&s.deques[t].lock);
+    s.deques[t].tiles.push_back(tile);
+    omp_unset_lock(&s.deques[t].lock);
+}
+
+//cuts the full image into WS_TILE tiles in row major order and gives every thread a contiguous block
+inline void ws_submit_image( WorkStealScheduler &s ) {
+    const int tiles_x = (DIM + WS_TILE - 1) / WS_TILE;
+    const int count = tiles_x * tiles_x;
+    for (int k=0; k<count; k++) {
+        Tile tile;
+        tile.x0 = (k % tiles_x) * WS_TILE;
+        tile.y0 = (k / tiles_x) * WS_TILE;
+        tile.x1 = tile.x0 + WS_TILE < DIM ? tile.x0 + WS_TILE : DIM;
+        tile.y1 = tile.y0 + WS_TILE < DIM ? tile.y0 + WS_TILE : DIM;
+        ws_submit(s, (int)((long long)k * s.threads / count), tile);
+    }
+}
+
+//own work comes off the back
+inline bool ws_pop( TileDeque &d, Tile &tile ) {
+    bool found = false;
+    omp_set_lock(&d.lock);
+    if (!d.tiles.empty()) {
+        tile = d.tiles.back();
+        d.tiles.pop_back();
+        found = true;
+    }
+    omp_unset_lock(&d.lock);
+    return found;
+}
+
+//stolen work comes off the front, the owner's tiles furthest from what it is doing now
+inline bool ws_steal( TileDeque &d, Tile &tile ) {
+    bool found = false;
+    omp_set_lock(&d.lock);
+    if (!d.tiles.empty()) {
+        tile = d.tiles.front();
+        d.tiles.pop_front();
+        found = true;
+    }
+    omp_unset_lock(&d.lock);
+    return found;
+}
+
+//render() policy: every submitted tile of s, each thread pops its own deque and then
+//steals from the others. render() has to run it on s.threads threads, stats gets what
+//each of them did
+struct WorkStealTiles {
+    WorkStealScheduler  &s;
+    WorkStealStats      &stats;
+
+    WorkStealTiles( WorkStealScheduler &sched, WorkStealStats &st ) : s(sched), stats(st) {
+        stats.busy.assign(s.threads, 0.0);
+        stats.idle.assign(s.threads, 0.0);
+        stats.tiles.assign(s.threads, 0);
+        stats.stolen.assign(s.threads, 0);
+    }
+
+    template <typename Visit>
+    void run( int t, int, Visit &visit ) const {
+        double begin = omp_get_wtime(), busy = 0.0;
+        int tiles = 0, stolen = 0; //counted locally, written to stats once at the end
+
+        while (true) {
+            Tile tile;
+            bool found = ws_pop(s.deques[t], tile);
+            //victims are tried in order starting after ourselves so thieves spread out
+            for (int v=1; !found && v<s.threads; v++) {
+                found = ws_steal(s.deques[(t + v) % s.threads], tile);
+                stolen += found;
+            }
+            if (!found)
+                break; //nothing is submitted during a run, so every deque stays empty now
+
+            double start = omp_get_wtime();
+            for (int y=tile.y0; y<tile.y1; y++) {
+                for (int x=tile.x0; x<tile.x1; x++)
+                    visit(x, y);
+            }
+            busy += omp_get_wtime() - start;
+            tiles++;
+        }
+
+        #pragma omp barrier
+        stats.busy[t] = busy;
+        stats.idle[t] = omp_get_wtime() - begin - busy; //out of work until the last thread finished
+        stats.tiles[t] = tiles;
+        stats.stolen[t] = stolen;
+    }
+};
+
+#endif  // __WORK_STEAL_H__